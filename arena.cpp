@@ -0,0 +1,351 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// arena: thousands of snakes and many dots on one shared board, every tick stepped in parallel
+
+#include<stddef.h>
+#include<string.h>
+
+#include"arena.h"
+
+// -------------
+// BIT FUNCTIONS
+// -------------
+
+// Function to set the bit of a cell in a bitset
+static void SetCellBit(uint64_t* bits, int cell) {
+        bits[cell >> 6] |= (uint64_t)1 << (cell & 63);
+}
+
+// Function to clear the bit of a cell in a bitset
+static void ClearCellBit(uint64_t* bits, int cell) {
+        bits[cell >> 6] &= ~((uint64_t)1 << (cell & 63));
+}
+
+// ---------------
+// SNAKE FUNCTIONS
+// ---------------
+
+// Function to get the position of the tail of a snake in its ring buffer
+static int TailSlot(Arena* arena, int snake) {
+        int slot = arena->headSlot[snake] - (arena->length[snake] - 1);
+        if (slot < 0) {
+                slot += arena->capacity[snake];
+        }
+        return slot;
+}
+
+// Function to move the body of a snake into a ring buffer twice as large, the tail goes to the first slot
+static void GrowArenaBody(Arena* arena, int snake) {
+        int capacity = arena->capacity[snake];
+        int* body = new int[capacity * 2];
+        int slot = TailSlot(arena, snake);
+        for (int i = 0; i < arena->length[snake]; i++) {
+                body[i] = arena->body[snake][slot];
+                slot = slot + 1 == capacity ? 0 : slot + 1;
+        }
+        delete[] arena->body[snake];
+        arena->body[snake] = body;
+        arena->capacity[snake] = capacity * 2;
+        arena->headSlot[snake] = arena->length[snake] - 1;
+}
+
+// Function to draw a random cell without a snake or a dot, -1 when none was found in ARENA_SPAWN_TRIES tries
+static int RandomFreeCell(Arena* arena) {
+        int cells = arena->width * arena->height;
+        for (int i = 0; i < ARENA_SPAWN_TRIES; i++) {
+                int cell = (int)RandomBelow(&arena->rng, cells);
+                if (!CellBit(arena->occupied, cell) && !CellBit(arena->dots, cell)) {
+                        return cell;
+                }
+        }
+        return -1;
+}
+
+// Function to put a new snake of length 1 on a random free cell, it stays dead when there is no room
+static void SpawnSnake(Arena* arena, int snake) {
+        int cell = RandomFreeCell(arena);
+        if (cell < 0) {
+                return;
+        }
+        arena->body[snake][0] = cell;
+        arena->headSlot[snake] = 0;
+        arena->length[snake] = 1;
+        arena->grow[snake] = 0;
+        arena->direction[snake] = (int8_t)RandomBelow(&arena->rng, 4);
+        arena->alive[snake] = 1;
+        SetCellBit(arena->occupied, cell);
+}
+
+// Function to take a dead snake off the board
+static void RemoveSnake(Arena* arena, int snake) {
+        int slot = TailSlot(arena, snake);
+        for (int i = 0; i < arena->length[snake]; i++) {
+                ClearCellBit(arena->occupied, arena->body[snake][slot]);
+                slot = slot + 1 == arena->capacity[snake] ? 0 : slot + 1;
+        }
+        arena->length[snake] = 0;
+        arena->alive[snake] = 0;
+}
+
+// Function to put new dots on random free cells until there are dotTarget of them (or no free cell is found)
+static void PlaceDots(Arena* arena) {
+        while (arena->dotCount < arena->dotTarget) {
+                int cell = RandomFreeCell(arena);
+                if (cell < 0) {
+                        return;
+                }
+                SetCellBit(arena->dots, cell);
+                arena->dotCount++;
+        }
+}
+
+// -----------------------
+// SPATIAL INDEX FUNCTIONS
+// -----------------------
+
+// Function to sort the snakes into the buckets of the cells they change (counting sort, snakes without a cell are left out)
+// Inside a bucket the snakes stay in their order, so every bucket is always handled the same way
+static void FillBuckets(Arena* arena, const int* cells, int* start, int* list) {
+        memset(start, 0, sizeof(int) * (arena->bucketCount + 1));
+        for (int i = 0; i < arena->count; i++) {
+                if (cells[i] >= 0) {
+                        start[cells[i] / ARENA_BUCKET_CELLS + 1]++;
+                }
+        }
+        for (int b = 0; b < arena->bucketCount; b++) {
+                start[b + 1] += start[b];
+                arena->cursor[b] = start[b];
+        }
+        for (int i = 0; i < arena->count; i++) {
+                if (cells[i] >= 0) {
+                        list[arena->cursor[cells[i] / ARENA_BUCKET_CELLS]++] = i;
+                }
+        }
+}
+
+// Function run for a range of buckets: free the cells the tails leave
+static void ReleaseTailsRange(void* context, int begin, int end) {
+        Arena* arena = (Arena*)context;
+        for (int k = arena->tailStart[begin]; k < arena->tailStart[end]; k++) {
+                ClearCellBit(arena->occupied, arena->leaving[arena->tailList[k]]);
+        }
+}
+
+// Function run for a range of snakes: turn and find the cell the head moves to, with the same rules as UpdateSnake
+// The tails are already gone, so a head may follow a tail and turn at the border into a cell a tail has just left
+static void PlanRange(void* context, int begin, int end) {
+        Arena* arena = (Arena*)context;
+        for (int i = begin; i < end; i++) {
+                arena->died[i] = 0;
+                arena->ate[i] = 0;
+                if (!arena->alive[i]) {
+                        arena->next[i] = -1;
+                        continue;
+                }
+                int cell = ArenaHead(arena, i);
+                Segment head;
+                head.x = cell % arena->width;
+                head.y = cell / arena->width;
+                int direction = arena->direction[i];
+                int action = arena->actions[i];
+                if (action != ACTION_NONE && TurnAllowed(&head, arena->length[i] + arena->grow[i], direction, action, arena->width, arena->height)) {
+                        direction = action;
+                }
+                MoveHead(arena->occupied, arena->width, arena->height, &head, &direction);
+                arena->direction[i] = (int8_t)direction;
+                if (InsideBoard(arena->width, arena->height, head.x, head.y)) {
+                        arena->next[i] = CellIndex(arena->width, head.x, head.y);
+                }
+                else {
+                        arena->next[i] = -1;
+                        arena->died[i] = 1;
+                }
+        }
+}
+
+// Function run for a range of buckets: settle the heads entering the cells of every bucket
+// Heads meeting in one cell all die, a head on a body dies, the other heads take their cell and eat its dot.
+// The cells and the bitset words of a bucket are changed only by the thread that has the bucket
+static void ResolveHeadsRange(void* context, int begin, int end) {
+        Arena* arena = (Arena*)context;
+        for (int b = begin; b < end; b++) {
+                int* list = arena->headList + arena->headStart[b];
+                int n = arena->headStart[b + 1] - arena->headStart[b];
+                // A bucket holds a few heads, an insertion sort by cell puts the heads of one cell next to each other
+                for (int i = 1; i < n; i++) {
+                        int snake = list[i];
+                        int j = i;
+                        while (j > 0 && arena->next[list[j - 1]] > arena->next[snake]) {
+                                list[j] = list[j - 1];
+                                j--;
+                        }
+                        list[j] = snake;
+                }
+                for (int i = 0; i < n;) {
+                        int cell = arena->next[list[i]];
+                        int same = i + 1;
+                        while (same < n && arena->next[list[same]] == cell) {
+                                same++;
+                        }
+                        if (same - i > 1 || CellBit(arena->occupied, cell)) {
+                                for (int j = i; j < same; j++) {
+                                        arena->died[list[j]] = 1;
+                                }
+                        }
+                        else {
+                                SetCellBit(arena->occupied, cell);
+                                if (CellBit(arena->dots, cell)) {
+                                        ClearCellBit(arena->dots, cell);
+                                        arena->ate[list[i]] = 1;
+                                }
+                        }
+                        i = same;
+                }
+        }
+}
+
+// Function run for a range of snakes: move the ring buffers, a dead snake only loses the tail it left
+static void UpdateBodiesRange(void* context, int begin, int end) {
+        Arena* arena = (Arena*)context;
+        for (int i = begin; i < end; i++) {
+                if (!arena->alive[i]) {
+                        continue;
+                }
+                if (arena->leaving[i] >= 0) {
+                        arena->length[i]--;
+                }
+                if (arena->died[i]) {
+                        continue;
+                }
+                if (arena->length[i] == arena->capacity[i]) {
+                        GrowArenaBody(arena, i);
+                }
+                arena->headSlot[i] = arena->headSlot[i] + 1 == arena->capacity[i] ? 0 : arena->headSlot[i] + 1;
+                arena->body[i][arena->headSlot[i]] = arena->next[i];
+                arena->length[i]++;
+                arena->grow[i] += arena->ate[i];
+        }
+}
+
+// ---------------
+// ARENA FUNCTIONS
+// ---------------
+
+void InitArena(Arena* arena, int width, int height, int count, int dots, int threadCount, uint64_t seed) {
+        int cells = width * height;
+        arena->width = width;
+        arena->height = height;
+        arena->words = (cells + 63) / 64;
+        arena->count = count;
+        arena->dotTarget = dots;
+        arena->dotCount = 0;
+        SeedRandom(&arena->rng, seed);
+        arena->occupied = new uint64_t[arena->words]();
+        arena->dots = new uint64_t[arena->words]();
+        arena->body = new int*[count];
+        arena->capacity = new int[count];
+        arena->headSlot = new int[count]();
+        arena->length = new int[count]();
+        arena->grow = new int[count]();
+        arena->direction = new int8_t[count]();
+        arena->alive = new uint8_t[count]();
+        arena->leaving = new int[count];
+        arena->next = new int[count];
+        arena->died = new uint8_t[count]();
+        arena->ate = new uint8_t[count]();
+        arena->bucketCount = (cells + ARENA_BUCKET_CELLS - 1) / ARENA_BUCKET_CELLS;
+        arena->tailStart = new int[arena->bucketCount + 1];
+        arena->tailList = new int[count];
+        arena->headStart = new int[arena->bucketCount + 1];
+        arena->headList = new int[count];
+        arena->cursor = new int[arena->bucketCount];
+        arena->actions = NULL;
+        arena->ticks = 0;
+        arena->deaths = 0;
+        arena->eaten = 0;
+        for (int i = 0; i < count; i++) {
+                arena->capacity[i] = SNAKE_CAPACITY;
+                arena->body[i] = new int[SNAKE_CAPACITY];
+                SpawnSnake(arena, i);
+        }
+        PlaceDots(arena);
+        InitThreadPool(&arena->pool, threadCount);
+}
+
+// Function to make one tick: the tails leave, the heads move, then the deaths and the eaten dots are settled
+// The parts that depend on the order of the snakes (new snakes, new dots) run on the calling thread
+void StepArena(Arena* arena, const int* actions) {
+        arena->actions = actions;
+        // The tails of the snakes that do not grow leave their cells first, like in UpdateSnake
+        for (int i = 0; i < arena->count; i++) {
+                arena->leaving[i] = -1;
+                if (!arena->alive[i]) {
+                        continue;
+                }
+                if (arena->grow[i] > 0) {
+                        arena->grow[i]--;
+                }
+                else {
+                        arena->leaving[i] = arena->body[i][TailSlot(arena, i)];
+                }
+        }
+        FillBuckets(arena, arena->leaving, arena->tailStart, arena->tailList);
+        ParallelFor(&arena->pool, arena->bucketCount, ReleaseTailsRange, arena);
+
+        ParallelFor(&arena->pool, arena->count, PlanRange, arena);
+        FillBuckets(arena, arena->next, arena->headStart, arena->headList);
+        ParallelFor(&arena->pool, arena->bucketCount, ResolveHeadsRange, arena);
+        ParallelFor(&arena->pool, arena->count, UpdateBodiesRange, arena);
+
+        arena->deaths = 0;
+        arena->eaten = 0;
+        for (int i = 0; i < arena->count; i++) {
+                if (arena->alive[i] && arena->died[i]) {
+                        RemoveSnake(arena, i);
+                        arena->deaths++;
+                }
+                arena->eaten += arena->ate[i];
+        }
+        for (int i = 0; i < arena->count; i++) {
+                if (!arena->alive[i]) {
+                        SpawnSnake(arena, i);
+                }
+        }
+        arena->dotCount -= arena->eaten;
+        PlaceDots(arena);
+        arena->actions = NULL;
+        arena->ticks++;
+}
+
+// Function to get the cell of the head, a dead snake (also one that found no room to spawn) has no head
+int ArenaHead(Arena* arena, int snake) {
+        if (!arena->alive[snake]) {
+                return -1;
+        }
+        return arena->body[snake][arena->headSlot[snake]];
+}
+
+void FreeArena(Arena* arena) {
+        FreeThreadPool(&arena->pool);
+        for (int i = 0; i < arena->count; i++) {
+                delete[] arena->body[i];
+        }
+        delete[] arena->body;
+        delete[] arena->capacity;
+        delete[] arena->headSlot;
+        delete[] arena->length;
+        delete[] arena->grow;
+        delete[] arena->direction;
+        delete[] arena->alive;
+        delete[] arena->leaving;
+        delete[] arena->next;
+        delete[] arena->died;
+        delete[] arena->ate;
+        delete[] arena->tailStart;
+        delete[] arena->tailList;
+        delete[] arena->headStart;
+        delete[] arena->headList;
+        delete[] arena->cursor;
+        delete[] arena->occupied;
+        delete[] arena->dots;
+}
@@ -0,0 +1,88 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// arena: thousands of snakes and many dots on one shared board, every tick stepped in parallel
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include<stdint.h>
+
+#include"game.h"
+#include"threadpool.h"
+
+// ------------------
+// DEFINING CONSTANTS
+// ------------------
+
+// Cells of one bucket of the spatial index, a multiple of 64 so no word of a bitset belongs to two buckets
+#define ARENA_BUCKET_CELLS 4096
+#define ARENA_SPAWN_TRIES 64 // random cells tried for a new snake or dot before giving up until the next tick
+
+// -------------------
+// DEFINING STRUCTURES
+// -------------------
+
+// Many snakes on one board, stored as a struct of arrays like VecEnv
+// The bodies and the dots are bitsets shared by all the snakes. The cells a tick changes (left tails, new heads)
+// are sorted into buckets of ARENA_BUCKET_CELLS cells, every bucket is handled by one thread in the order of the snakes,
+// so the result of a tick does not depend on the number of threads
+struct Arena {
+        int width; // the size of the board in cells
+        int height;
+        int words; // number of 64 bit words in a bitset of the board
+        int count; // number of snakes
+        int dotTarget; // the number of dots kept on the board
+        int dotCount;
+        ThreadPool pool;
+        Random rng; // new snakes and dots, only used by the serial parts of a tick
+
+        uint64_t* occupied; // one bit for every cell taken by a snake
+        uint64_t* dots; // one bit for every cell with a dot
+
+        // per-snake arrays
+        int** body; // ring buffer with the cells of every snake, the head is at headSlot
+        int* capacity; // slots of every ring buffer, it doubles when the snake outgrows it
+        int* headSlot;
+        int* length;
+        int* grow; // segments still to be added at the tail
+        int8_t* direction;
+        uint8_t* alive;
+        int* leaving; // cell the tail leaves in the current tick, -1 when the snake grows or is dead
+        int* next; // cell the head moves to in the current tick, -1 when it leaves the board
+        uint8_t* died; // the snake died in the last tick
+        uint8_t* ate; // the snake ate a dot in the last tick
+
+        // spatial index of the current tick, bucket b holds the entries [start[b], start[b + 1]) of its list
+        int bucketCount;
+        int* tailStart;
+        int* tailList; // snakes whose tails leave a cell of the bucket
+        int* headStart;
+        int* headList; // snakes whose heads enter a cell of the bucket
+        int* cursor; // next free entry of every bucket while a list is filled
+
+        const int* actions; // actions of the tick in progress
+        long long ticks; // ticks made so far
+        int deaths; // snakes that died in the last tick
+        int eaten; // dots eaten in the last tick
+};
+
+// ---------------
+// ARENA FUNCTIONS
+// ---------------
+
+// create count snakes of length 1 and dots dots on a width x height board (it has to pass BoardSizeAllowed)
+// threadCount includes the calling thread, 0 means one thread per core
+void InitArena(Arena* arena, int width, int height, int count, int dots, int threadCount, uint64_t seed);
+
+// make one move of every snake, actions[i] is a direction or ACTION_NONE
+// heads moving into a body or into each other die, a head on a dot eats it. Dead snakes leave the board
+// and come back as new snakes in the same tick, when there is room for them
+void StepArena(Arena* arena, const int* actions);
+
+// the cell of the head of a snake, -1 when it is dead
+int ArenaHead(Arena* arena, int snake);
+
+// free the arena and stop the threads
+void FreeArena(Arena* arena);
+
+#endif
@@ -0,0 +1,38 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// assets: the font and the dot compiled into the game, so it starts without reading any file
+
+#include<stddef.h>
+
+#include"assets.h"
+#include"assets_data.h"
+
+#if DOT_SIZE != CELL_SIZE
+#error "blue_dot.bmp was scaled to another CELL_SIZE, run tools/embed_assets.cpp again"
+#endif
+
+// ----------------
+// ASSETS FUNCTIONS
+// ----------------
+
+// Function to wrap compiled ARGB8888 pixels in a surface, black becomes transparent and the other pixels are copied as they are
+SDL_Surface* CreateAssetSurface(const Uint32* pixels, int width, int height) {
+        // SDL only reads the pixels of a surface that is blitted from, so they can stay in the constant data
+        SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom((void*)pixels, width, height, 32, width * 4, SDL_PIXELFORMAT_ARGB8888);
+        if (surface == NULL) {
+                return NULL;
+        }
+        SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+        SDL_SetColorKey(surface, true, SDL_MapRGB(surface->format, 0x00, 0x00, 0x00));
+        return surface;
+}
+
+// Function to make the surface of the font, a 128x128 bitmap of 16 x 16 characters
+SDL_Surface* CreateFontSurface() {
+        return CreateAssetSurface(FONT_PIXELS, FONT_SIZE, FONT_SIZE);
+}
+
+// Function to make the surface of the dot, already of the size of a cell
+SDL_Surface* CreateDotSurface() {
+        return CreateAssetSurface(DOT_PIXELS, DOT_SIZE, DOT_SIZE);
+}
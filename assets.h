@@ -0,0 +1,23 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// assets: the font and the dot compiled into the game, so it starts without reading any file
+
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include"draw.h"
+
+// ----------------
+// ASSETS FUNCTIONS
+// ----------------
+
+// the pixels of cs8x8.bmp and blue_dot.bmp in ARGB8888, made by tools/embed_assets.cpp
+extern const Uint32 FONT_PIXELS[];
+extern const Uint32 DOT_PIXELS[];
+
+// surfaces over the compiled pixels (nothing is copied) with black as the transparent color, free them with SDL_FreeSurface
+// the pixels are constant, so the surfaces are only drawn from
+SDL_Surface* CreateFontSurface();
+SDL_Surface* CreateDotSurface();
+
+#endif
@@ -0,0 +1,533 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// autopilot: a player that drives the snake by itself, for soak tests and for generating long games
+
+#include<stdlib.h>
+#include<limits.h>
+#include<chrono>
+
+#include"autopilot.h"
+
+// ---------------------------
+// HAMILTONIAN CYCLE FUNCTIONS
+// ---------------------------
+
+// Function to get the place of the cell (x, y) on the cycle
+// Column 0 is the way back: the cycle starts at (0, 0), runs over the columns 1.. of the rows in turns
+// and comes back up column 0. When both sides are odd the last two rows are run in pairs of cells instead,
+// and the corner (0, height - 1) shares its place with (1, height - 2), both lie between the same two cells
+static int CycleOrderAt(Autopilot* pilot, int x, int y) {
+        if (pilot->transposed) {
+                int swap = x;
+                x = y;
+                y = swap;
+        }
+        int w = pilot->cycleWidth;
+        int h = pilot->cycleHeight;
+        if (pilot->oddCycle && y >= h - 2) {
+                if (x == 0 && y == h - 1) {
+                        x = 1;
+                        y = h - 2;
+                }
+                if (x > 0) {
+                        int k = w - 1 - x;
+                        return 1 + (h - 2) * (w - 1) + 2 * k + ((k % 2 == 0) == (y == h - 1) ? 1 : 0);
+                }
+        }
+        if (x == 0) {
+                if (y == 0) {
+                        return 0;
+                }
+                return pilot->cycleLength - y;
+        }
+        return 1 + y * (w - 1) + (y % 2 == 0 ? x - 1 : w - 1 - x);
+}
+
+// Function to get the place of a cell on the cycle
+static int CycleOrder(Autopilot* pilot, int cell) {
+        return CycleOrderAt(pilot, cell % pilot->width, cell / pilot->width);
+}
+
+// Function to count the places on the cycle from the tail forward to a place (the tail is at 0, the head is the furthest body place)
+static int PlaceFromTail(Autopilot* pilot, int order, int tailOrder) {
+        int place = order - tailOrder;
+        return place < 0 ? place + pilot->cycleLength : place;
+}
+
+// Function to count the places on the cycle from one cell forward to another
+static int CycleDistance(Autopilot* pilot, int from, int to) {
+        int distance = CycleOrder(pilot, to) - CycleOrder(pilot, from);
+        return distance < 0 ? distance + pilot->cycleLength : distance;
+}
+
+// --------------
+// MOVE FUNCTIONS
+// --------------
+
+// Function to get the cell next to a cell in the given direction, -1 outside the board
+static int NeighborCell(Autopilot* pilot, int cell, int direction) {
+        int x = cell % pilot->width;
+        int y = cell / pilot->width;
+        if (direction == RIGHT) {
+                x++;
+        }
+        else if (direction == LEFT) {
+                x--;
+        }
+        else if (direction == UP) {
+                y--;
+        }
+        else {
+                y++;
+        }
+        return InsideBoard(pilot->width, pilot->height, x, y) ? CellIndex(pilot->width, x, y) : -1;
+}
+
+// Function to find the cell the head moves to on the next StepGame with the given action, -1 when it leaves the board
+// The turn and the move follow TurnSnake and UpdateSnake: the turn needs canMove, the tail is left before the head
+// moves and the head turns by itself at the border
+static int PredictMove(Game* game, int action) {
+        Snake* snake = &game->snake;
+        Segment head = SnakeSegment(snake, 0);
+        int direction = snake->direction;
+        if (action != ACTION_NONE && game->canMove && TurnAllowed(&head, snake->length + snake->grow, direction, action, snake->width, snake->height)) {
+                direction = action;
+        }
+        int tail = SnakeCell(snake, snake->length - 1);
+        uint64_t bit = (uint64_t)1 << (tail & 63);
+        if (snake->grow == 0) {
+                snake->occupied[tail >> 6] &= ~bit;
+        }
+        MoveHead(snake->occupied, snake->width, snake->height, &head, &direction);
+        if (snake->grow == 0) {
+                snake->occupied[tail >> 6] |= bit;
+        }
+        return InsideBoard(snake->width, snake->height, head.x, head.y) ? CellIndex(snake->width, head.x, head.y) : -1;
+}
+
+// Function to check if the head can move into a cell without dying, the tail cell counts as free when the tail leaves it
+static bool CellFree(Game* game, int cell) {
+        Snake* snake = &game->snake;
+        if (!CellBit(snake->occupied, cell)) {
+                return true;
+        }
+        return snake->grow == 0 && cell == SnakeCell(snake, snake->length - 1);
+}
+
+// Function to check if the next move can take the head into the cell next to it in the given direction
+static bool MoveLegal(Game* game, int direction, int cell) {
+        return PredictMove(game, game->canMove ? direction : ACTION_NONE) == cell && CellFree(game, cell);
+}
+
+// Function to get the next cell after the head on the cycle that the snake can move into, -1 when there is none
+// Of the two cells sharing a place the dot is taken first, then the one that is not the corner
+static int CycleSuccessor(Autopilot* pilot, Game* game, int head, int relHead, int tailOrder, int dot) {
+        int corner = pilot->oddCycle ? CellIndex(pilot->width, 0, pilot->height - 1) : -1;
+        int next = relHead + 1 == pilot->cycleLength ? 0 : relHead + 1;
+        int best = -1;
+        for (int direction = 0; direction < 4; direction++) {
+                int cell = NeighborCell(pilot, head, direction);
+                if (cell < 0 || PlaceFromTail(pilot, CycleOrder(pilot, cell), tailOrder) != next) {
+                        continue;
+                }
+                if (!MoveLegal(game, direction, cell)) {
+                        continue;
+                }
+                if (best < 0 || cell == dot || (best == corner && best != dot)) {
+                        best = cell;
+                }
+        }
+        return best;
+}
+
+// Function to pick a move for a snake that does not lie on the cycle in order, like after the player drove it
+// The next cell on the cycle is taken when it is free, otherwise the free cell with the most free cells around it
+static int SurvivalMove(Autopilot* pilot, Game* game, int head) {
+        int best = -1;
+        int bestRoom = -1;
+        for (int direction = 0; direction < 4; direction++) {
+                int cell = NeighborCell(pilot, head, direction);
+                if (cell < 0 || !MoveLegal(game, direction, cell)) {
+                        continue;
+                }
+                if (CycleDistance(pilot, head, cell) == 1) {
+                        return cell;
+                }
+                int room = 0;
+                for (int around = 0; around < 4; around++) {
+                        int next = NeighborCell(pilot, cell, around);
+                        if (next >= 0 && next != head && CellFree(game, next)) {
+                                room++;
+                        }
+                }
+                if (room > bestRoom) {
+                        best = cell;
+                        bestRoom = room;
+                }
+        }
+        return best;
+}
+
+// Function to get the direction from a cell to the cell next to it
+static int DirectionTo(int from, int to) {
+        if (to == from + 1) {
+                return RIGHT;
+        }
+        if (to == from - 1) {
+                return LEFT;
+        }
+        return to < from ? UP : DOWN;
+}
+
+// --------------
+// PATH FUNCTIONS
+// --------------
+
+// Function to get the i-th cell of the planned path
+static int PathCell(Autopilot* pilot, int i) {
+        int slot = pilot->pathStart + i;
+        return pilot->path[slot >= pilot->pathCapacity ? slot - pilot->pathCapacity : slot];
+}
+
+// Function to forget the planned path
+static void ClearPath(Autopilot* pilot) {
+        pilot->pathStart = 0;
+        pilot->pathLength = 0;
+        pilot->pathComplete = 0;
+        pilot->pathDot = -1;
+}
+
+// Function to make room in the path for count more cells, the ring buffer is moved into a larger one
+static void ReservePath(Autopilot* pilot, int count) {
+        int capacity = pilot->pathCapacity;
+        while (pilot->pathLength + count > capacity) {
+                capacity *= 2;
+        }
+        if (capacity == pilot->pathCapacity) {
+                return;
+        }
+        int* path = new int[capacity];
+        for (int i = 0; i < pilot->pathLength; i++) {
+                path[i] = PathCell(pilot, i);
+        }
+        delete[] pilot->path;
+        pilot->path = path;
+        pilot->pathCapacity = capacity;
+        pilot->pathStart = 0;
+}
+
+// Function to drop the first cell of the path, the head has moved into it
+static void PopPath(Autopilot* pilot) {
+        pilot->pathStart++;
+        if (pilot->pathStart == pilot->pathCapacity) {
+                pilot->pathStart = 0;
+        }
+        pilot->pathLength--;
+}
+
+// ----------------
+// SEARCH FUNCTIONS
+// ----------------
+
+// Function to find the node of a cell in the current search, -1 when the cell was not reached yet
+static int FindNode(Autopilot* pilot, int cell, int* slot) {
+        int mask = pilot->tableSize - 1;
+        int i = (int)(((unsigned)cell * 2654435761u) & (unsigned)mask);
+        while (pilot->tableStamp[i] == pilot->stamp) {
+                if (pilot->nodes[pilot->table[i]].cell == cell) {
+                        return pilot->table[i];
+                }
+                i = (i + 1) & mask;
+        }
+        *slot = i;
+        return -1;
+}
+
+// Function to check if node a should be expanded before node b
+// The shorter estimated path goes first, of equal ones the longer part already walked, so the search goes straight on
+static bool NodeBefore(Autopilot* pilot, int a, int b) {
+        SearchNode* na = &pilot->nodes[a];
+        SearchNode* nb = &pilot->nodes[b];
+        if (na->g + na->h != nb->g + nb->h) {
+                return na->g + na->h < nb->g + nb->h;
+        }
+        if (na->g != nb->g) {
+                return na->g > nb->g;
+        }
+        return a < b;
+}
+
+// Function to add a node to the heap of open nodes
+static void PushNode(Autopilot* pilot, int node) {
+        int i = pilot->heapCount++;
+        while (i > 0) {
+                int parent = (i - 1) / 2;
+                if (!NodeBefore(pilot, node, pilot->heap[parent])) {
+                        break;
+                }
+                pilot->heap[i] = pilot->heap[parent];
+                i = parent;
+        }
+        pilot->heap[i] = node;
+}
+
+// Function to take the first node out of the heap of open nodes
+static int PopNode(Autopilot* pilot) {
+        int first = pilot->heap[0];
+        int last = pilot->heap[--pilot->heapCount];
+        int i = 0;
+        while (true) {
+                int child = 2 * i + 1;
+                if (child >= pilot->heapCount) {
+                        break;
+                }
+                if (child + 1 < pilot->heapCount && NodeBefore(pilot, pilot->heap[child + 1], pilot->heap[child])) {
+                        child++;
+                }
+                if (!NodeBefore(pilot, pilot->heap[child], last)) {
+                        break;
+                }
+                pilot->heap[i] = pilot->heap[child];
+                i = child;
+        }
+        if (pilot->heapCount > 0) {
+                pilot->heap[i] = last;
+        }
+        return first;
+}
+
+// Function to add a node for the cell (x, y) at the given place on the cycle, reached from parent after g moves
+static int AddNode(Autopilot* pilot, int slot, int x, int y, int place, int parent, int g, int dotX, int dotY) {
+        int node = pilot->nodeCount++;
+        SearchNode* n = &pilot->nodes[node];
+        n->cell = CellIndex(pilot->width, x, y);
+        n->place = place;
+        n->parent = parent;
+        n->g = g;
+        n->h = abs(x - dotX) + abs(y - dotY);
+        n->closed = 0;
+        pilot->table[slot] = node;
+        pilot->tableStamp[slot] = pilot->stamp;
+        PushNode(pilot, node);
+        return node;
+}
+
+// Function to extend the path from its last cell (or the head) towards the dot with A*, expanding at most AUTOPILOT_BUDGET cells
+// Only moves forward on the cycle that do not pass the dot are searched. All those cells lie between the head and the tail,
+// so they are free, and the dot can be reached from every one of them. When the dot is not found, the path is extended
+// to the expanded cell nearest to it, which is always further on the cycle, and the search goes on from there next time
+static void ExtendPath(Autopilot* pilot, int head, int tailOrder, int dot) {
+        int start = pilot->pathLength > 0 ? PathCell(pilot, pilot->pathLength - 1) : head;
+        int dotX = dot % pilot->width;
+        int dotY = dot / pilot->width;
+        int dotPlace = PlaceFromTail(pilot, CycleOrderAt(pilot, dotX, dotY), tailOrder);
+        if (pilot->stamp == INT_MAX) {
+                for (int i = 0; i < pilot->tableSize; i++) {
+                        pilot->tableStamp[i] = 0;
+                }
+                pilot->stamp = 0;
+        }
+        pilot->stamp++;
+        pilot->nodeCount = 0;
+        pilot->heapCount = 0;
+        int slot;
+        FindNode(pilot, start, &slot);
+        AddNode(pilot, slot, start % pilot->width, start / pilot->width, PlaceFromTail(pilot, CycleOrder(pilot, start), tailOrder), -1, 0, dotX, dotY);
+        int best = 0;
+        int expanded = 0;
+        bool found = false;
+        while (pilot->heapCount > 0 && expanded < AUTOPILOT_BUDGET) {
+                int node = PopNode(pilot);
+                SearchNode* n = &pilot->nodes[node];
+                if (n->closed) {
+                        continue;
+                }
+                n->closed = 1;
+                if (n->cell == dot) {
+                        best = node;
+                        found = true;
+                        break;
+                }
+                expanded++;
+                if (node != 0 && (best == 0 || n->h < pilot->nodes[best].h || (n->h == pilot->nodes[best].h && n->g > pilot->nodes[best].g))) {
+                        best = node;
+                }
+                int x = n->cell % pilot->width;
+                int y = n->cell / pilot->width;
+                int place = n->place;
+                int g = n->g + 1;
+                for (int direction = 0; direction < 4; direction++) {
+                        int nextX = x + (direction == RIGHT) - (direction == LEFT);
+                        int nextY = y + (direction == DOWN) - (direction == UP);
+                        if (!InsideBoard(pilot->width, pilot->height, nextX, nextY)) {
+                                continue;
+                        }
+                        int nextPlace = PlaceFromTail(pilot, CycleOrderAt(pilot, nextX, nextY), tailOrder);
+                        if (nextPlace <= place || nextPlace > dotPlace) {
+                                continue;
+                        }
+                        int other = FindNode(pilot, CellIndex(pilot->width, nextX, nextY), &slot);
+                        if (other < 0) {
+                                AddNode(pilot, slot, nextX, nextY, nextPlace, node, g, dotX, dotY);
+                        }
+                        else if (!pilot->nodes[other].closed && g < pilot->nodes[other].g) {
+                                pilot->nodes[other].g = g;
+                                pilot->nodes[other].parent = node;
+                                PushNode(pilot, other);
+                        }
+                }
+        }
+        pilot->lastExpanded = expanded;
+        // The cells from the start to the best node are added at the end of the path, walking back over the parents
+        int count = pilot->nodes[best].g;
+        ReservePath(pilot, count);
+        for (int node = best; pilot->nodes[node].parent >= 0; node = pilot->nodes[node].parent) {
+                int i = pilot->pathStart + pilot->pathLength + pilot->nodes[node].g - 1;
+                pilot->path[i % pilot->pathCapacity] = pilot->nodes[node].cell;
+        }
+        pilot->pathLength += count;
+        pilot->pathDot = dot;
+        pilot->pathComplete = found;
+}
+
+// -------------------
+// AUTOPILOT FUNCTIONS
+// -------------------
+
+// Function to prepare the autopilot and the Hamiltonian cycle of a width x height board
+// The cycle needs an even side along which its rows are run, when only the width is even the board is seen transposed
+void InitAutopilot(Autopilot* pilot, int width, int height) {
+        pilot->width = width;
+        pilot->height = height;
+        pilot->transposed = height % 2 != 0 && width % 2 == 0;
+        pilot->cycleWidth = pilot->transposed ? height : width;
+        pilot->cycleHeight = pilot->transposed ? width : height;
+        pilot->oddCycle = width % 2 != 0 && height % 2 != 0;
+        pilot->cycleLength = width * height - (pilot->oddCycle ? 1 : 0);
+        pilot->pathCapacity = AUTOPILOT_PATH_CAPACITY;
+        pilot->path = new int[pilot->pathCapacity];
+        int nodes = 4 * AUTOPILOT_BUDGET + 1;
+        pilot->nodes = new SearchNode[nodes];
+        pilot->heap = new int[nodes];
+        pilot->tableSize = 1;
+        while (pilot->tableSize < 2 * nodes) {
+                pilot->tableSize *= 2;
+        }
+        pilot->table = new int[pilot->tableSize];
+        pilot->tableStamp = new int[pilot->tableSize]();
+        pilot->stamp = 0;
+        pilot->nodeCount = 0;
+        pilot->heapCount = 0;
+        pilot->decisions = 0;
+        pilot->totalNs = 0;
+        pilot->maxNs = 0;
+        pilot->lastNs = 0;
+        pilot->lastExpanded = 0;
+        ResetAutopilot(pilot);
+}
+
+// Function to forget the plan, the order of the body is counted again on the next decision
+void ResetAutopilot(Autopilot* pilot) {
+        ClearPath(pilot);
+        pilot->steps = 0;
+        pilot->expectedHead = -1;
+        pilot->expectedMoves = -1;
+}
+
+// Function to choose the next cell of the head
+// The order of the body is kept up to date from the decided moves, it is counted over the whole body only
+// when the game moved without the autopilot
+static int PlanMove(Autopilot* pilot, Game* game) {
+        Snake* snake = &game->snake;
+        int head = SnakeCell(snake, 0);
+        int tail = SnakeCell(snake, snake->length - 1);
+        int dot = CellIndex(snake->width, game->blueDot.x, game->blueDot.y);
+        if (game->moves != pilot->expectedMoves || head != pilot->expectedHead) {
+                ClearPath(pilot);
+                pilot->steps = 0;
+                for (int i = snake->length - 1; i > 0; i--) {
+                        pilot->steps += CycleDistance(pilot, SnakeCell(snake, i), SnakeCell(snake, i - 1));
+                }
+        }
+        if (pilot->pathDot != dot) {
+                ClearPath(pilot);
+        }
+        if (pilot->steps >= pilot->cycleLength) {
+                return SurvivalMove(pilot, game, head);
+        }
+        int tailOrder = CycleOrder(pilot, tail);
+        int relHead = PlaceFromTail(pilot, CycleOrder(pilot, head), tailOrder);
+        int relDot = PlaceFromTail(pilot, CycleOrder(pilot, dot), tailOrder);
+        // Near a full board there is no room for shortcuts, the snake goes round the cycle
+        bool cycleOnly = (long long)(snake->length + snake->grow) * 100 >= (long long)AUTOPILOT_CYCLE_FILL * pilot->cycleLength;
+        // After reaching the dot the head has to stay behind the tail by the growth and the slack
+        int relLimit = pilot->cycleLength - 2 - snake->grow - AUTOPILOT_SLACK;
+        if (cycleOnly || relDot <= relHead || relDot > relLimit) {
+                ClearPath(pilot);
+        }
+        else {
+                // A long unfinished path is walked for a while before it is extended again
+                if (!pilot->pathComplete && pilot->pathLength < AUTOPILOT_BUDGET) {
+                        ExtendPath(pilot, head, tailOrder, dot);
+                }
+                if (pilot->pathLength > 0) {
+                        int next = PathCell(pilot, 0);
+                        int relNext = PlaceFromTail(pilot, CycleOrder(pilot, next), tailOrder);
+                        if (relNext > relHead && MoveLegal(game, DirectionTo(head, next), next)) {
+                                return next;
+                        }
+                        // The path does not fit the snake any more, it is planned again from the head
+                        ClearPath(pilot);
+                }
+        }
+        int next = CycleSuccessor(pilot, game, head, relHead, tailOrder, dot);
+        return next >= 0 ? next : SurvivalMove(pilot, game, head);
+}
+
+// Function to decide the next action and measure how long it took
+int AutopilotDecide(Autopilot* pilot, Game* game) {
+        if (game->gameOver) {
+                return ACTION_NONE;
+        }
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        Snake* snake = &game->snake;
+        pilot->lastExpanded = 0;
+        int head = SnakeCell(snake, 0);
+        int target = PlanMove(pilot, game);
+        // No turn is made when the snake gets there anyway, so a replay keeps only the real turns
+        int action = target >= 0 && game->canMove && PredictMove(game, ACTION_NONE) != target ? DirectionTo(head, target) : ACTION_NONE;
+        int next = PredictMove(game, action);
+        if (pilot->pathLength > 0 && PathCell(pilot, 0) == next) {
+                PopPath(pilot);
+        }
+        else {
+                ClearPath(pilot);
+        }
+        // The walked places change by the step of the head and the step the tail leaves behind
+        if (next >= 0) {
+                pilot->steps += CycleDistance(pilot, head, next);
+                if (snake->grow == 0) {
+                        int tail = SnakeCell(snake, snake->length - 1);
+                        pilot->steps -= CycleDistance(pilot, tail, snake->length > 1 ? SnakeCell(snake, snake->length - 2) : next);
+                }
+        }
+        pilot->expectedHead = next;
+        pilot->expectedMoves = game->moves + 1;
+        long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        pilot->decisions++;
+        pilot->totalNs += ns;
+        pilot->lastNs = ns;
+        if (ns > pilot->maxNs) {
+                pilot->maxNs = ns;
+        }
+        return action;
+}
+
+// Function to free the memory of the autopilot
+void FreeAutopilot(Autopilot* pilot) {
+        delete[] pilot->path;
+        delete[] pilot->nodes;
+        delete[] pilot->heap;
+        delete[] pilot->table;
+        delete[] pilot->tableStamp;
+}
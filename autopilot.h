@@ -0,0 +1,90 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// autopilot: a player that drives the snake by itself, for soak tests and for generating long games
+
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+#include"game.h"
+
+// ------------------
+// DEFINING CONSTANTS
+// ------------------
+
+#define AUTOPILOT_BUDGET 1024 // The most cells the path search may expand for one decision
+#define AUTOPILOT_SLACK 4 // Free cells kept in front of the tail after a shortcut, on top of the pending growth
+#define AUTOPILOT_CYCLE_FILL 50 // Percent of the board taken by the snake from which it only follows the cycle
+#define AUTOPILOT_PATH_CAPACITY 64 // The first size of the ring buffer of the planned path, it doubles when needed
+
+// -------------------
+// DEFINING STRUCTURES
+// -------------------
+
+// A cell reached by the path search
+struct SearchNode {
+        int cell;
+        int place; // places on the cycle from the tail
+        int parent; // index of the node it was reached from, -1 for the start
+        int g; // moves from the start
+        int h; // moves left to the dot at least (the Manhattan distance)
+        int closed; // the node was expanded
+};
+
+// The snake follows a Hamiltonian cycle of the board and takes shortcuts along it to the dot.
+// While the body lies on the cycle in order from the tail to the head, following the cycle always leads to the tail,
+// so a shortcut is safe when it keeps the order and leaves room in front of the tail.
+// The path to the dot is searched with A* in AUTOPILOT_BUDGET cells per decision. An unfinished search leaves
+// a part of the path that is followed and extended on the next decisions, a finished path is used until the dot is eaten.
+struct Autopilot {
+        int width; // the size of the board in cells
+        int height;
+        int transposed; // the cycle runs along the columns instead of the rows (the height is odd, the width even)
+        int cycleWidth; // the size of the board as the cycle sees it, cycleHeight is even unless both sides are odd
+        int cycleHeight;
+        int oddCycle; // both sides are odd, the cycle skips the bottom left corner, which shares the place of its neighbor
+        int cycleLength; // the number of places on the cycle
+
+        long long steps; // cycle places walked from the tail to the head along the body, below cycleLength while it is in order
+        int expectedHead; // the cell the head moves to on the decided move, to notice moves the autopilot did not make
+        int expectedMoves;
+
+        int* path; // ring buffer of the planned cells, the first one is the next move
+        int pathCapacity;
+        int pathStart;
+        int pathLength;
+        int pathDot; // the cell of the dot the path leads to
+        int pathComplete; // the path ends on the dot
+
+        SearchNode* nodes; // the nodes of the current search, 4 * AUTOPILOT_BUDGET + 1 of them
+        int nodeCount;
+        int* heap; // open nodes ordered by the estimated length of the path through them
+        int heapCount;
+        int* table; // hash table from a cell to its node, tableSize entries
+        int* tableStamp; // search number that filled each entry, older entries count as empty
+        int tableSize;
+        int stamp;
+
+        long long decisions; // planning time of the decisions, measured by AutopilotDecide
+        long long totalNs;
+        long long maxNs;
+        long long lastNs;
+        int lastExpanded; // cells expanded by the last search
+};
+
+// -------------------
+// AUTOPILOT FUNCTIONS
+// -------------------
+
+// prepare the autopilot for games on a width x height board
+void InitAutopilot(Autopilot* pilot, int width, int height);
+
+// forget the plan, the next decision looks at the snake again (done by itself when the game changed behind its back)
+void ResetAutopilot(Autopilot* pilot);
+
+// the action for the next StepGame of the game, ACTION_NONE keeps the direction
+// the work of a decision is bounded by AUTOPILOT_BUDGET on any board, its time is added to the stats
+int AutopilotDecide(Autopilot* pilot, Game* game);
+
+void FreeAutopilot(Autopilot* pilot);
+
+#endif
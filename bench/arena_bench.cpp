@@ -0,0 +1,99 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// arena_bench: ticks an arena of many snakes on 1, 2, 4, ... threads and reports the time of a tick
+//
+// build: g++ -O2 -pthread bench/arena_bench.cpp arena.cpp game.cpp threadpool.cpp -o arena_bench
+// usage: arena_bench [snakes] [ticks] [max threads] [board size] [dots]
+//
+// prints CSV: snakes,board,threads,ticks,tick_ms,p99_ms,speedup,deaths_per_tick,dots_per_tick,hash
+// the hash of the final board has to be the same for every number of threads
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<chrono>
+#include<thread>
+#include<algorithm>
+
+#include"../arena.h"
+
+#define ACTION_ROWS 64 // number of prepared action rows, the ticks cycle through them
+
+// Function to hash the bodies, the dots and the heads of the arena (FNV-1a over 64 bit words)
+uint64_t HashArena(Arena* arena) {
+        uint64_t hash = 0xCBF29CE484222325ULL;
+        for (int i = 0; i < arena->words; i++) {
+                hash = (hash ^ arena->occupied[i]) * 0x100000001B3ULL;
+                hash = (hash ^ arena->dots[i]) * 0x100000001B3ULL;
+        }
+        for (int i = 0; i < arena->count; i++) {
+                hash = (hash ^ (uint64_t)ArenaHead(arena, i)) * 0x100000001B3ULL;
+        }
+        return hash;
+}
+
+int main(int argc, char** argv) {
+        int snakes = argc > 1 ? atoi(argv[1]) : 10000;
+        int ticks = argc > 2 ? atoi(argv[2]) : 500;
+        int maxThreads = argc > 3 ? atoi(argv[3]) : (int)std::thread::hardware_concurrency();
+        int size = argc > 4 ? atoi(argv[4]) : 2000;
+        int dots = argc > 5 ? atoi(argv[5]) : snakes * 2;
+        if (maxThreads <= 0) {
+                maxThreads = 1;
+        }
+        if (!BoardSizeAllowed(size, size)) {
+                printf("Wrong board size %d\n", size);
+                return 1;
+        }
+
+        // Random actions are prepared up front, so the main thread does not generate them during the timing
+        int* actions = new int[(size_t)ACTION_ROWS * snakes];
+        srand(1);
+        for (int i = 0; i < ACTION_ROWS * snakes; i++) {
+                actions[i] = rand() % 8 == 0 ? rand() % 4 : ACTION_NONE;
+        }
+
+        printf("snakes,board,threads,ticks,tick_ms,p99_ms,speedup,deaths_per_tick,dots_per_tick,hash\n");
+        double* tickMs = new double[ticks];
+        double single = 0;
+        uint64_t expected = 0;
+        int failed = 0;
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+                Arena arena;
+                InitArena(&arena, size, size, snakes, dots, threads, 1);
+                long long deaths = 0, eaten = 0;
+                double total = 0;
+                for (int tick = 0; tick < ticks; tick++) {
+                        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                        StepArena(&arena, actions + (size_t)(tick % ACTION_ROWS) * snakes);
+                        tickMs[tick] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                        total += tickMs[tick];
+                        deaths += arena.deaths;
+                        eaten += arena.eaten;
+                }
+                std::sort(tickMs, tickMs + ticks);
+                double mean = total / ticks;
+                if (threads == 1) {
+                        single = mean;
+                }
+                uint64_t hash = HashArena(&arena);
+                if (threads == 1) {
+                        expected = hash;
+                }
+                else if (hash != expected) {
+                        failed++;
+                }
+                printf("%d,%dx%d,%d,%d,%.3f,%.3f,%.2f,%.1f,%.1f,%016llx\n", snakes, size, size, threads, ticks, mean, tickMs[ticks * 99 / 100],
+                        single / mean, (double)deaths / ticks, (double)eaten / ticks, (unsigned long long)hash);
+                FreeArena(&arena);
+                if (threads < maxThreads && threads * 2 > maxThreads) {
+                        threads = maxThreads / 2;
+                }
+        }
+
+        delete[] tickMs;
+        delete[] actions;
+        if (failed) {
+                printf("The arena ended differently on %d thread counts\n", failed);
+        }
+        return failed != 0;
+}
@@ -0,0 +1,81 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// autopilot_bench: plays whole games with the autopilot on small boards, then a fixed number of moves on large ones
+//
+// build: g++ -O2 bench/autopilot_bench.cpp autopilot.cpp game.cpp -o autopilot_bench
+// usage: autopilot_bench [games per board] [moves on a large board]
+//
+// prints CSV: board,games,won,died,last_cell,moves_per_game,fill,eaten,ns_per_decision,p99_ns,max_ns,expanded_per_decision,max_expanded
+// The autopilot should win every game on a board with an even side. A board with both sides odd has no Hamiltonian cycle,
+// the snake fills all cells but one and mostly dies going for the last one: those games are counted in last_cell
+// as well as in died, they are expected losses. Anything else in died is a bug.
+// The times are wall clock, max_ns also catches the thread being descheduled on a busy machine. The work of a decision
+// is bounded by max_expanded (at most AUTOPILOT_BUDGET cells, about 0.2 ms on 1000 x 1000), p99_ns shows the usual worst
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<vector>
+#include<algorithm>
+
+#include"../autopilot.h"
+
+// Boards played until the games end, the odd ones use the cycle that skips a corner
+const int SMALL_BOARDS[][2] = { { ROW_CELLS, COL_CELLS }, { 20, 20 }, { 21, 21 }, { 15, 8 }, { 2, 2 }, { 3, 3 } };
+
+// Boards on which only a fixed number of moves is played
+const int LARGE_BOARDS[][2] = { { 1000, 1000 }, { 10000, 10000 } };
+
+// Function to play games with the autopilot and print one line of results
+// maxMoves limits every game, 0 plays it to the end
+void PlayBoard(int width, int height, int games, long long maxMoves) {
+        Autopilot pilot;
+        InitAutopilot(&pilot, width, height);
+        int won = 0;
+        int died = 0;
+        int lastCell = 0;
+        long long moves = 0;
+        long long eaten = 0;
+        long long expanded = 0;
+        int maxExpanded = 0;
+        std::vector<long long> times; // the time of every decision, for the percentile
+        double fill = 0;
+        for (int i = 0; i < games; i++) {
+                Game game;
+                InitGameOfSize(&game, i + 1, width, height);
+                ResetAutopilot(&pilot);
+                while (!game.gameOver && (maxMoves == 0 || game.moves < maxMoves)) {
+                        int result = StepGame(&game, AutopilotDecide(&pilot, &game));
+                        expanded += pilot.lastExpanded;
+                        maxExpanded = std::max(maxExpanded, pilot.lastExpanded);
+                        times.push_back(pilot.lastNs);
+                        if (result & STEP_ATE) {
+                                eaten++;
+                        }
+                }
+                won += game.gameWon;
+                died += game.gameOver && !game.gameWon;
+                lastCell += game.gameOver && !game.gameWon && width % 2 != 0 && height % 2 != 0 && game.snake.length >= width * height - 1;
+                moves += game.moves;
+                fill += (double)game.snake.length / ((double)width * height);
+                FreeGame(&game);
+        }
+        std::vector<long long>::iterator p99 = times.begin() + times.size() * 99 / 100;
+        std::nth_element(times.begin(), p99, times.end());
+        printf("%dx%d,%d,%d,%d,%d,%lld,%.4f,%lld,%.0f,%lld,%lld,%.1f,%d\n", width, height, games, won, died, lastCell, moves / games, fill / games, eaten,
+                (double)pilot.totalNs / pilot.decisions, *p99, pilot.maxNs, (double)expanded / pilot.decisions, maxExpanded);
+        FreeAutopilot(&pilot);
+}
+
+int main(int argc, char** argv) {
+        int games = argc > 1 ? atoi(argv[1]) : 10;
+        long long largeMoves = argc > 2 ? atoll(argv[2]) : 1000000;
+
+        printf("board,games,won,died,last_cell,moves_per_game,fill,eaten,ns_per_decision,p99_ns,max_ns,expanded_per_decision,max_expanded\n");
+        for (int i = 0; i < (int)(sizeof(SMALL_BOARDS) / sizeof(SMALL_BOARDS[0])); i++) {
+                PlayBoard(SMALL_BOARDS[i][0], SMALL_BOARDS[i][1], games, 0);
+        }
+        for (int i = 0; i < (int)(sizeof(LARGE_BOARDS) / sizeof(LARGE_BOARDS[0])); i++) {
+                PlayBoard(LARGE_BOARDS[i][0], LARGE_BOARDS[i][1], 1, largeMoves);
+        }
+        return 0;
+}
@@ -0,0 +1,76 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// bench_util: the timing loop and the snakes on a cycle shared by the benchmarks, every benchmark is one file including it
+
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include<chrono>
+
+#include"../game.h"
+
+// ------------------
+// DEFINING CONSTANTS
+// ------------------
+
+#define MIN_SECONDS 0.2 // every benchmark is repeated with twice the operations until it takes at least this long
+
+static volatile int sink; // results are added here, so the measured calls cannot be optimized away
+
+// ----------------
+// TIMING FUNCTIONS
+// ----------------
+
+// Function to get the time in seconds since start
+inline double SecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Function to run a benchmark with more and more operations until it takes at least MIN_SECONDS
+// Returns the operations of the last run, its time is stored in seconds
+template<typename Context>
+long long RunLongEnough(double (*bench)(Context*, long long), Context* context, double* seconds) {
+        long long ops = 16;
+        *seconds = bench(context, ops);
+        while (*seconds < MIN_SECONDS) {
+                ops *= 2;
+                *seconds = bench(context, ops);
+        }
+        return ops;
+}
+
+// ---------------
+// CYCLE FUNCTIONS
+// ---------------
+
+// Function to get the direction of a cycle through every cell of a width x height board (height has to be even)
+// Even rows go right and odd rows go left over the columns 1..width-1, column 0 leads back up to the first row
+inline int CycleDirection(int x, int y, int width, int height) {
+        if (x == 0) {
+                return y > 0 ? UP : RIGHT;
+        }
+        if (y % 2 == 0) {
+                return x < width - 1 ? RIGHT : DOWN;
+        }
+        if (x > 1 || y == height - 1) {
+                return LEFT;
+        }
+        return DOWN;
+}
+
+// Function to move the snake one cell along the cycle, a snake on the cycle never collides with itself
+inline void MoveOnCycle(Snake* snake) {
+        Segment head = SnakeSegment(snake, 0);
+        snake->direction = CycleDirection(head.x, head.y, snake->width, snake->height);
+        UpdateSnake(snake);
+}
+
+// Function to grow the snake along the cycle to the given length
+inline void GrowOnCycle(Snake* snake, int length) {
+        while (snake->length < length) {
+                growSnake(snake);
+                MoveOnCycle(snake);
+        }
+}
+
+#endif
@@ -0,0 +1,209 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// hot_path_bench: times the functions run on every move and every frame for snakes filling 1% to 99% of the board,
+// then for snakes of growing length on a board of 10000 x 10000 cells seen through the camera
+//
+// build: g++ -O2 bench/hot_path_bench.cpp game.cpp draw.cpp raster.cpp assets.cpp -LSDL2-2.0.10/lib -lSDL2 -o hot_path_bench
+//
+// prints CSV: bench,board,length,fill,ops,ns_per_op,items_per_s
+// items are moves, checks and dots for the game functions, snake cells for DrawSnake, grid lines for DrawGrid
+// and visible cells for the frame
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<chrono>
+
+#include"../game.h"
+#include"../draw.h"
+#include"../assets.h"
+#include"bench_util.h"
+
+// Snake fills of the board that are measured, in percent
+const int FILLS[] = { 1, 5, 10, 25, 50, 75, 90, 99 };
+
+#define HUGE_WIDTH 10000 // The size of the huge board, the drawing functions only see the cells in the view
+#define HUGE_HEIGHT 10000
+
+// Snake lengths measured on the huge board
+const int HUGE_LENGTHS[] = { 1000, 100000, 1000000, 10000000 };
+
+// Function to grow the snake along the cycle of a width x height board to the given length
+void BuildSnake(Snake* snake, int width, int height, int length) {
+        InitSnake(snake, width, height);
+        GrowOnCycle(snake, length);
+}
+
+// Function to print one result line, items is the number of items handled by one operation
+void Report(const char* name, Snake* snake, long long ops, double seconds, double items) {
+        double fill = (double)snake->length / ((double)snake->width * snake->height);
+        printf("%s,%dx%d,%d,%.6f,%lld,%.2f,%.0f\n", name, snake->width, snake->height, snake->length, fill, ops, seconds * 1e9 / ops, ops * items / seconds);
+}
+
+// Function to run ops moves along the cycle and return the time they took
+double TimeUpdate(Snake* snake, long long ops) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < ops; i++) {
+                MoveOnCycle(snake);
+        }
+        return SecondsSince(start);
+}
+
+// Function to check all four turns from every cell of the snake in turn
+double TimeCanTurn(Snake* snake, long long ops) {
+        int found = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < ops; i++) {
+                Segment segment = SnakeSegment(snake, (int)((i >> 2) % snake->length));
+                found += canTurn(snake, segment.x, segment.y, (int)(i & 3));
+        }
+        double seconds = SecondsSince(start);
+        sink += found;
+        return seconds;
+}
+
+// Function to check the collision of the head
+double TimeCollision(Snake* snake, long long ops) {
+        int found = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < ops; i++) {
+                found += checkCollision(snake);
+        }
+        double seconds = SecondsSince(start);
+        sink += found;
+        return seconds;
+}
+
+// Function to place the dot on a random free cell
+double TimeInitDot(Snake* snake, long long ops) {
+        Random rng;
+        SeedRandom(&rng, 1);
+        Dot dot;
+        int sum = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < ops; i++) {
+                InitDot(&dot, snake, &rng);
+                sum += dot.x;
+        }
+        double seconds = SecondsSince(start);
+        sink += sum;
+        return seconds;
+}
+
+// Surfaces and colors the drawing benchmarks use
+struct RenderContext {
+        SDL_Surface* screen;
+        SDL_Surface* charset;
+        SDL_Surface* dotSurface;
+        BackgroundCache background;
+        Camera camera; // centered on the head of the measured snake
+        Uint32 czarny;
+        Uint32 szary;
+        Uint32 czerwony;
+        Uint32 zielony;
+        Uint32 bialy;
+};
+
+RenderContext* renderContext;
+
+// Function to draw the whole snake over the last frame
+double TimeDrawSnake(Snake* snake, long long ops) {
+        RenderContext* r = renderContext;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < ops; i++) {
+                DrawSnake(r->screen, snake, &r->camera, r->czerwony, r->zielony, r->bialy);
+        }
+        return SecondsSince(start);
+}
+
+// Function to draw the grid of the board
+double TimeDrawGrid(Snake*, long long ops) {
+        RenderContext* r = renderContext;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < ops; i++) {
+                DrawGrid(r->screen, &r->camera, r->szary);
+        }
+        return SecondsSince(start);
+}
+
+// Function to compose whole frames the way main() does on a full redraw: static layer, snake, dot and info text
+double TimeFrame(Snake* snake, long long ops) {
+        RenderContext* r = renderContext;
+        Dot dot;
+        Random rng;
+        SeedRandom(&rng, 1);
+        InitDot(&dot, snake, &rng);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < ops; i++) {
+                PrepareBackground(&r->background, r->screen, &r->camera, r->czarny, r->czerwony, r->czarny, r->szary);
+                RestoreBackground(r->screen, &r->background, NULL);
+                DrawSnake(r->screen, snake, &r->camera, r->czerwony, r->zielony, r->bialy);
+                DrawDot(r->screen, r->dotSurface, &dot, &r->camera);
+                DrawString(r->screen, 8, 10, "Time: 12.3 s", r->charset);
+                DrawString(r->screen, 8, 26, "Esc - exit, n - new game, p - pause", r->charset);
+        }
+        return SecondsSince(start);
+}
+
+// Function to run a benchmark with more and more operations until it takes long enough, then print it
+void Run(const char* name, double (*bench)(Snake*, long long), Snake* snake, double items) {
+        double seconds;
+        long long ops = RunLongEnough(bench, snake, &seconds);
+        Report(name, snake, ops, seconds, items);
+}
+
+// Function to run all the benchmarks on one snake, the camera is centered on its head
+void RunAll(Snake* snake) {
+        RenderContext* r = renderContext;
+        Segment head = SnakeSegment(snake, 0);
+        InitCamera(&r->camera, snake->width, snake->height, &head);
+        int gridLines = (r->camera.columns + 1) + (r->camera.rows + 1);
+        Run("UpdateSnake", TimeUpdate, snake, 1);
+        Run("canTurn", TimeCanTurn, snake, 1);
+        Run("checkCollision", TimeCollision, snake, 1);
+        Run("InitDot", TimeInitDot, snake, 1);
+        Run("DrawSnake", TimeDrawSnake, snake, snake->length);
+        Run("DrawGrid", TimeDrawGrid, snake, gridLines);
+        Run("Frame", TimeFrame, snake, r->camera.columns * r->camera.rows);
+}
+
+int main(int, char**) {
+        RenderContext render;
+        render.screen = SDL_CreateRGBSurface(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+        render.charset = CreateFontSurface();
+        render.dotSurface = CreateDotSurface();
+        if (render.screen == NULL || render.charset == NULL || render.dotSurface == NULL) {
+                printf("SDL error: %s\n", SDL_GetError());
+                return 1;
+        }
+        InitBackground(&render.background);
+        render.czarny = SDL_MapRGB(render.screen->format, 0x00, 0x00, 0x00);
+        render.szary = SDL_MapRGB(render.screen->format, 0x80, 0x80, 0x80);
+        render.czerwony = SDL_MapRGB(render.screen->format, 0xFF, 0x00, 0x00);
+        render.zielony = SDL_MapRGB(render.screen->format, 0x00, 0xFF, 0x00);
+        render.bialy = SDL_MapRGB(render.screen->format, 0xFF, 0xFF, 0xFF);
+        renderContext = &render;
+
+        printf("bench,board,length,fill,ops,ns_per_op,items_per_s\n");
+        for (int i = 0; i < (int)(sizeof(FILLS) / sizeof(FILLS[0])); i++) {
+                int length = ROW_CELLS * COL_CELLS * FILLS[i] / 100;
+                if (length < 1) {
+                        length = 1;
+                }
+                Snake snake;
+                BuildSnake(&snake, ROW_CELLS, COL_CELLS, length);
+                RunAll(&snake);
+                FreeSnake(&snake);
+        }
+        for (int i = 0; i < (int)(sizeof(HUGE_LENGTHS) / sizeof(HUGE_LENGTHS[0])); i++) {
+                Snake snake;
+                BuildSnake(&snake, HUGE_WIDTH, HUGE_HEIGHT, HUGE_LENGTHS[i]);
+                RunAll(&snake);
+                FreeSnake(&snake);
+        }
+
+        FreeBackground(&render.background);
+        SDL_FreeSurface(render.dotSurface);
+        SDL_FreeSurface(render.charset);
+        SDL_FreeSurface(render.screen);
+        return 0;
+}
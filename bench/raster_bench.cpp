@@ -0,0 +1,139 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// raster_bench: compares the old per-pixel drawing with the span fills from raster.cpp
+//
+// build: g++ -O2 -mavx2 bench/raster_bench.cpp raster.cpp -o raster_bench
+
+#include<stdio.h>
+#include<stdint.h>
+#include<stdlib.h>
+#include<chrono>
+
+#include"../raster.h"
+
+#define SCREEN_WIDTH 640
+#define SCREEN_HEIGHT 440
+#define INFO_AREA_HEIGHT (SCREEN_HEIGHT / 11)
+#define GAME_BOARD_HEIGHT (SCREEN_HEIGHT - INFO_AREA_HEIGHT)
+#define CELL_SIZE 20
+
+// A copy of the surface fields the old DrawPixel read on every call
+struct PixelSurface {
+        uint8_t* pixels;
+        int pitch;
+        int bytesPerPixel;
+};
+
+// ---------------------------------
+// PER-PIXEL PATH (the old functions)
+// ---------------------------------
+
+void PixelDrawPixel(PixelSurface* surface, int x, int y, uint32_t color) {
+        int bpp = surface->bytesPerPixel;
+        uint8_t* p = surface->pixels + y * surface->pitch + x * bpp;
+        *(uint32_t*)p = color;
+}
+
+void PixelDrawLine(PixelSurface* screen, int x, int y, int l, int dx, int dy, uint32_t color) {
+        for (int i = 0; i < l; i++) {
+                PixelDrawPixel(screen, x, y, color);
+                x += dx;
+                y += dy;
+        }
+}
+
+void PixelDrawRectangle(PixelSurface* screen, int x, int y, int l, int k, uint32_t outlineColor, uint32_t fillColor) {
+        PixelDrawLine(screen, x, y, k, 0, 1, outlineColor);
+        PixelDrawLine(screen, x + l - 1, y, k, 0, 1, outlineColor);
+        PixelDrawLine(screen, x, y, l, 1, 0, outlineColor);
+        PixelDrawLine(screen, x, y + k - 1, l, 1, 0, outlineColor);
+        for (int i = y + 1; i < y + k - 1; i++) {
+                PixelDrawLine(screen, x + 1, i, l - 2, 1, 0, fillColor);
+        }
+}
+
+// The background, the grid (without the off-screen last lines) and a snake covering the whole board
+void PixelFrame(PixelSurface* screen) {
+        PixelDrawRectangle(screen, 0, 0, SCREEN_WIDTH, INFO_AREA_HEIGHT, 0xFF000000, 0xFFFF0000);
+        PixelDrawRectangle(screen, 0, INFO_AREA_HEIGHT, SCREEN_WIDTH, GAME_BOARD_HEIGHT, 0xFF000000, 0xFF000000);
+        for (int x = 0; x < SCREEN_WIDTH; x += CELL_SIZE) {
+                PixelDrawLine(screen, x, INFO_AREA_HEIGHT, GAME_BOARD_HEIGHT, 0, 1, 0xFF808080);
+        }
+        for (int y = INFO_AREA_HEIGHT; y < SCREEN_HEIGHT; y += CELL_SIZE) {
+                PixelDrawLine(screen, 0, y, SCREEN_WIDTH, 1, 0, 0xFF808080);
+        }
+        for (int y = INFO_AREA_HEIGHT; y < SCREEN_HEIGHT; y += CELL_SIZE) {
+                for (int x = 0; x < SCREEN_WIDTH; x += CELL_SIZE) {
+                        PixelDrawRectangle(screen, x, y, CELL_SIZE, CELL_SIZE, 0xFFFFFFFF, 0xFF00FF00);
+                }
+        }
+}
+
+// ----------------------------
+// SPAN PATH (raster functions)
+// ----------------------------
+
+void SpanFrame(RasterTarget* target) {
+        RasterRectangle(target, 0, 0, SCREEN_WIDTH, INFO_AREA_HEIGHT, 0xFF000000, 0xFFFF0000);
+        RasterRectangle(target, 0, INFO_AREA_HEIGHT, SCREEN_WIDTH, GAME_BOARD_HEIGHT, 0xFF000000, 0xFF000000);
+        for (int x = 0; x < SCREEN_WIDTH; x += CELL_SIZE) {
+                RasterVLine(target, x, INFO_AREA_HEIGHT, GAME_BOARD_HEIGHT, 0xFF808080);
+        }
+        for (int y = INFO_AREA_HEIGHT; y < SCREEN_HEIGHT; y += CELL_SIZE) {
+                RasterHLine(target, 0, y, SCREEN_WIDTH, 0xFF808080);
+        }
+        for (int y = INFO_AREA_HEIGHT; y < SCREEN_HEIGHT; y += CELL_SIZE) {
+                for (int x = 0; x < SCREEN_WIDTH; x += CELL_SIZE) {
+                        RasterRectangle(target, x, y, CELL_SIZE, CELL_SIZE, 0xFFFFFFFF, 0xFF00FF00);
+                }
+        }
+}
+
+// Function to time a number of frames, returns nanoseconds per frame
+template<typename F>
+double TimeFrames(int frames, F frame) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i++) {
+                frame();
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / frames;
+}
+
+int main(int argc, char** argv) {
+        int frames = argc > 1 ? atoi(argv[1]) : 2000;
+
+        uint32_t* pixelBuffer = new uint32_t[SCREEN_WIDTH * SCREEN_HEIGHT];
+        uint32_t* spanBuffer = new uint32_t[SCREEN_WIDTH * SCREEN_HEIGHT];
+
+        PixelSurface surface;
+        surface.pixels = (uint8_t*)pixelBuffer;
+        surface.pitch = SCREEN_WIDTH * 4;
+        surface.bytesPerPixel = 4;
+
+        RasterTarget target;
+        target.pixels = spanBuffer;
+        target.pitch = SCREEN_WIDTH;
+        target.w = SCREEN_WIDTH;
+        target.h = SCREEN_HEIGHT;
+
+        double pixelTime = TimeFrames(frames, [&]() { PixelFrame(&surface); });
+        double spanTime = TimeFrames(frames, [&]() { SpanFrame(&target); });
+
+        // Both paths have to produce the same picture
+        int mismatches = 0;
+        for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
+                if (pixelBuffer[i] != spanBuffer[i]) {
+                        mismatches++;
+                }
+        }
+
+        printf("per-pixel: %.0f ns/frame\n", pixelTime);
+        printf("span:      %.0f ns/frame\n", spanTime);
+        printf("speedup:   %.2fx\n", pixelTime / spanTime);
+        printf("mismatched pixels: %d\n", mismatches);
+
+        delete[] pixelBuffer;
+        delete[] spanBuffer;
+        return mismatches != 0;
+}
@@ -0,0 +1,135 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// replay_bench: plays replays back headless, checks that they give the same games and reports moves per second
+//
+// build: g++ -O2 bench/replay_bench.cpp replay.cpp game.cpp -o replay_bench
+//
+// replay_bench FILE [seek move] - play a replay saved with --record and print how the game ended
+// replay_bench [games]          - record games of a random player, save, load and play them back,
+//                                 then seek to random moves and check the head of the snake every time
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<chrono>
+
+#include"../game.h"
+#include"../replay.h"
+#include"bench_util.h"
+
+#define MAX_MOVES 200000 // the random games are cut at this many moves
+
+// Function to play a replay file from the start and report the result
+int PlayFile(const char* path, int seekMove) {
+        Replay replay;
+        if (!LoadReplay(&replay, path)) {
+                printf("Cannot load the replay %s\n", path);
+                return 1;
+        }
+        ReplayPlayer player;
+        InitReplayPlayer(&player, &replay, REPLAY_CHECKPOINT_MOVES);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int eaten = 0;
+        int result;
+        while ((result = PlayReplayMove(&player)) != 0) {
+                if (result & STEP_ATE) {
+                        eaten++;
+                }
+        }
+        double seconds = SecondsSince(start);
+
+        Game* game = &player.game;
+        printf("seed: %llu, board: %dx%d, turns: %d, moves: %d of %d\n", (unsigned long long)replay.seed, replay.width, replay.height,
+                replay.turnCount, game->moves, replay.moves);
+        printf("dots eaten: %d, length: %d, %s\n", eaten, game->snake.length, game->gameWon ? "won" : game->gameOver ? "game over" : "not finished");
+        printf("%.0f moves/s\n", game->moves / seconds);
+
+        if (seekMove >= 0) {
+                SeekReplay(&player, seekMove);
+                Segment head = SnakeSegment(&game->snake, 0);
+                printf("move %d: head at (%d, %d), length %d, dot at (%d, %d)\n", game->moves, head.x, head.y, game->snake.length, game->blueDot.x, game->blueDot.y);
+        }
+
+        FreeReplayPlayer(&player);
+        FreeReplay(&replay);
+        return 0;
+}
+
+int main(int argc, char** argv) {
+        if (argc > 1 && atoi(argv[1]) == 0) {
+                return PlayFile(argv[1], argc > 2 ? atoi(argv[2]) : -1);
+        }
+        int games = argc > 1 ? atoi(argv[1]) : 100;
+        srand(1);
+
+        int* heads = new int[MAX_MOVES + 1];
+        long long recordedMoves = 0, playedMoves = 0, seeks = 0;
+        double playSeconds = 0, seekSeconds = 0;
+        int failed = 0;
+        for (int i = 0; i < games; i++) {
+                // Record a game of a random player, with the cell of the head after every move
+                Game game;
+                Replay replay;
+                InitGame(&game, 1000 + i);
+                InitReplay(&replay, game.seed, game.snake.width, game.snake.height);
+                heads[0] = CellIndex(ROW_CELLS, game.snake.headSegment.x, game.snake.headSegment.y);
+                while (!game.gameOver && game.moves < MAX_MOVES) {
+                        if (rand() % 8 == 0) {
+                                int direction = rand() % 4;
+                                if (TurnSnake(&game, direction)) {
+                                        RecordTurn(&replay, game.moves, direction);
+                                }
+                        }
+                        StepGame(&game, ACTION_NONE);
+                        heads[game.moves] = CellIndex(ROW_CELLS, game.snake.headSegment.x, game.snake.headSegment.y);
+                }
+                replay.moves = game.moves;
+                recordedMoves += game.moves;
+
+                // Save and load it again
+                Replay loaded;
+                if (!SaveReplay(&replay, "replay_bench.snrp") || !LoadReplay(&loaded, "replay_bench.snrp")) {
+                        printf("Cannot save or load the replay\n");
+                        return 1;
+                }
+
+                // Play it back, it has to end exactly like the recorded game
+                ReplayPlayer player;
+                InitReplayPlayer(&player, &loaded, REPLAY_CHECKPOINT_MOVES);
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                while (PlayReplayMove(&player)) {
+                }
+                playSeconds += SecondsSince(start);
+                playedMoves += player.game.moves;
+                Game* played = &player.game;
+                if (played->moves != game.moves || played->gameOver != game.gameOver || played->snake.length != game.snake.length
+                        || played->blueDot.x != game.blueDot.x || played->blueDot.y != game.blueDot.y) {
+                        failed++;
+                }
+
+                // Seek back and forth, the head has to be where it was in the recorded game
+                start = std::chrono::steady_clock::now();
+                for (int j = 0; j < 100; j++) {
+                        int move = rand() % (game.moves + 1);
+                        SeekReplay(&player, move);
+                        Segment head = SnakeSegment(&player.game.snake, 0);
+                        if (player.game.moves != move || CellIndex(ROW_CELLS, head.x, head.y) != heads[move]) {
+                                failed++;
+                        }
+                        seeks++;
+                }
+                seekSeconds += SecondsSince(start);
+
+                FreeReplayPlayer(&player);
+                FreeReplay(&loaded);
+                FreeReplay(&replay);
+                FreeGame(&game);
+        }
+        remove("replay_bench.snrp");
+        delete[] heads;
+
+        printf("games: %d, moves: %lld, mismatches: %d\n", games, recordedMoves, failed);
+        printf("playback: %.0f moves/s\n", playedMoves / playSeconds);
+        printf("seek: %.1f us per seek\n", seekSeconds * 1e6 / seeks);
+        return failed != 0;
+}
@@ -0,0 +1,101 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// reset_bench: the memory of one game and the time to start the next one, freeing and allocating the game again
+// against ResetGame in the memory of the last one
+//
+// build: g++ -O2 bench/reset_bench.cpp game.cpp -o reset_bench
+// usage: reset_bench [moves before every restart]
+//
+// prints CSV: bench,board,moves,ops,ns_per_op,bytes_per_game,segment_bytes_per_game
+// every operation plays the given moves (8 by default) and starts a new game, as a soak run of short games does.
+// The LongSnake rows grow one snake along a cycle for the given moves (half the board, at most LONG_SNAKE cells)
+// to show the memory of a long body. segment_bytes_per_game is the same game in the layout before the body held
+// packed cells: an x, y pair of ints for every slot and the free cell tree in an allocation of its own
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<chrono>
+
+#include"../game.h"
+#include"bench_util.h"
+
+// Boards measured, the time of a new allocation grows with the board, the time of a reset with the snake
+const int BOARDS[][2] = { { ROW_CELLS, COL_CELLS }, { 100, 100 }, { 1000, 1000 }, { 10000, 10000 } };
+
+#define LONG_SNAKE 1000000 // the longest snake of the LongSnake rows
+
+int playMoves = 8; // moves before every restart, unless given on the command line
+
+// Function to get the bytes the game would take with the body kept as Segment pairs (the old layout)
+size_t SegmentLayoutMemory(Game* game) {
+        Snake* snake = &game->snake;
+        return sizeof(Game) - sizeof(Segment) + sizeof(Segment) * (size_t)snake->capacity
+                + sizeof(uint64_t) * (size_t)snake->words + sizeof(int) * (size_t)(snake->blocks + 1);
+}
+
+// Function to play a few moves of the game, turning now and then so the snake does not only run along the border
+void PlayMoves(Game* game) {
+        for (int i = 0; i < playMoves && !game->gameOver; i++) {
+                StepGame(game, i % 4 == 3 ? (i / 4) % 4 : ACTION_NONE);
+        }
+        sink += game->snake.length;
+}
+
+// Function to restart the game ops times by freeing it and initializing a new one
+double TimeInit(Game* game, long long ops) {
+        int width = game->snake.width;
+        int height = game->snake.height;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < ops; i++) {
+                PlayMoves(game);
+                FreeGame(game);
+                InitGameOfSize(game, (uint64_t)i, width, height);
+        }
+        return SecondsSince(start);
+}
+
+// Function to restart the game ops times with ResetGame
+double TimeReset(Game* game, long long ops) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < ops; i++) {
+                PlayMoves(game);
+                ResetGame(game, (uint64_t)i);
+        }
+        return SecondsSince(start);
+}
+
+// Function to run a benchmark with more and more operations until it takes long enough, then print it
+void Run(const char* name, double (*bench)(Game*, long long), int width, int height) {
+        Game game;
+        InitGameOfSize(&game, 1, width, height);
+        double seconds;
+        long long ops = RunLongEnough(bench, &game, &seconds);
+        printf("%s,%dx%d,%d,%lld,%.1f,%zu,%zu\n", name, width, height, playMoves, ops, seconds * 1e9 / ops, GameMemory(&game), SegmentLayoutMemory(&game));
+        FreeGame(&game);
+}
+
+// Function to grow one snake over half the board and print the memory of the game with it
+void RunLongSnake(int width, int height) {
+        int length = width * height / 2 < LONG_SNAKE ? width * height / 2 : LONG_SNAKE;
+        Game game;
+        InitGameOfSize(&game, 1, width, height);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        GrowOnCycle(&game.snake, length);
+        double seconds = SecondsSince(start);
+        printf("LongSnake,%dx%d,%d,1,%.1f,%zu,%zu\n", width, height, length, seconds * 1e9, GameMemory(&game), SegmentLayoutMemory(&game));
+        FreeGame(&game);
+}
+
+int main(int argc, char** argv) {
+        if (argc > 1) {
+                playMoves = atoi(argv[1]);
+        }
+
+        printf("bench,board,moves,ops,ns_per_op,bytes_per_game,segment_bytes_per_game\n");
+        for (int i = 0; i < (int)(sizeof(BOARDS) / sizeof(BOARDS[0])); i++) {
+                Run("FreeGame+InitGameOfSize", TimeInit, BOARDS[i][0], BOARDS[i][1]);
+                Run("ResetGame", TimeReset, BOARDS[i][0], BOARDS[i][1]);
+                RunLongSnake(BOARDS[i][0], BOARDS[i][1]);
+        }
+        return 0;
+}
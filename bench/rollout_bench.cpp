@@ -0,0 +1,205 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// rollout_bench: saving and restoring positions for lookahead search, CopyGame against snapshots and the undo log,
+// then random rollouts from one position with each of them, on small and large boards with short and long snakes
+//
+// build: g++ -O2 bench/rollout_bench.cpp game.cpp -o rollout_bench
+// usage: rollout_bench [moves per rollout]
+//
+// prints CSV: bench,board,length,ops,ns_per_op,ops_per_s
+// ops are clones or restores for the first benchmarks and whole rollouts (moves and the way back) for the Rollout ones.
+// The position restored by a snapshot and by the undo log is compared with a CopyGame of it, before and after the timing,
+// and the program fails when they differ
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<chrono>
+
+#include"../game.h"
+#include"bench_util.h"
+
+#define ROLLOUT_MOVES 32 // moves of a rollout, unless given on the command line
+
+// Positions measured: the size of the board and the length of the snake (the height has to be even)
+const int POSITIONS[][3] = {
+        { ROW_CELLS, COL_CELLS, 1 }, { ROW_CELLS, COL_CELLS, 320 }, { ROW_CELLS, COL_CELLS, 600 },
+        { 1000, 1000, 1000 }, { 1000, 1000, 100000 },
+        { 10000, 10000, 1000 }, { 10000, 10000, 1000000 }
+};
+
+int rolloutMoves = ROLLOUT_MOVES;
+// Function to start a game whose snake was grown along the cycle to the given length, with a dot on a free cell
+void BuildGame(Game* game, int width, int height, int length) {
+        InitGameOfSize(game, 1, width, height);
+        GrowOnCycle(&game->snake, length);
+        InitDot(&game->blueDot, &game->snake, &game->rng);
+        game->canMove = 1;
+}
+
+// Function to play random moves, a fifth of them keep the direction
+void PlayRandom(Game* game, Random* policy, UndoLog* log) {
+        for (int i = 0; i < rolloutMoves && !game->gameOver; i++) {
+                int action = (int)RandomBelow(policy, 5);
+                if (action == 4) {
+                        action = ACTION_NONE;
+                }
+                if (log != NULL) {
+                        StepGameLogged(game, action, log);
+                }
+                else {
+                        StepGame(game, action);
+                }
+        }
+        sink += game->moves;
+}
+
+// The position every benchmark starts from and the state kept between its operations
+struct BenchContext {
+        Game root;
+        Game scratch; // a second game on the same board for CopyGame
+        Game reference; // a CopyGame of the position, the restored games are compared with it
+        GameSnapshot snapshot;
+        UndoLog log;
+        Random policy;
+};
+
+// Function to clone the position into another game with CopyGame, the whole board is copied
+double TimeCopyGame(BenchContext* c, long long ops) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < ops; i++) {
+                CopyGame(&c->scratch, &c->root);
+        }
+        return SecondsSince(start);
+}
+
+// Function to save the position into a snapshot
+double TimeSaveSnapshot(BenchContext* c, long long ops) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < ops; i++) {
+                SaveGameSnapshot(&c->snapshot, &c->root);
+        }
+        return SecondsSince(start);
+}
+
+// Function to restore the position from a snapshot, the snake is taken off the board and put back every time
+double TimeRestoreSnapshot(BenchContext* c, long long ops) {
+        SaveGameSnapshot(&c->snapshot, &c->root);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < ops; i++) {
+                RestoreGameSnapshot(&c->root, &c->snapshot);
+        }
+        return SecondsSince(start);
+}
+
+// Function to run rollouts in a copy of the position made with CopyGame
+double TimeRolloutCopy(BenchContext* c, long long ops) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < ops; i++) {
+                CopyGame(&c->scratch, &c->root);
+                PlayRandom(&c->scratch, &c->policy, NULL);
+        }
+        return SecondsSince(start);
+}
+
+// Function to run rollouts from the position and restore it from a snapshot after each of them
+double TimeRolloutSnapshot(BenchContext* c, long long ops) {
+        SaveGameSnapshot(&c->snapshot, &c->root);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < ops; i++) {
+                PlayRandom(&c->root, &c->policy, NULL);
+                RestoreGameSnapshot(&c->root, &c->snapshot);
+        }
+        return SecondsSince(start);
+}
+
+// Function to run rollouts from the position and take their moves back with the undo log
+double TimeRolloutUndo(BenchContext* c, long long ops) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < ops; i++) {
+                PlayRandom(&c->root, &c->policy, &c->log);
+                UndoMoves(&c->root, &c->log, rolloutMoves);
+        }
+        return SecondsSince(start);
+}
+
+// Function to check that a game is the same position as the reference: the cells of the snake, the bitset,
+// the free tree, the generator and the fields the next moves depend on. The body may start at another slot of the ring
+bool SamePosition(Game* game, Game* reference) {
+        Snake* a = &game->snake;
+        Snake* b = &reference->snake;
+        if (a->length != b->length || a->grow != b->grow || a->direction != b->direction || a->collided != b->collided
+                || a->headSegment.x != b->headSegment.x || a->headSegment.y != b->headSegment.y || a->freeCount != b->freeCount) {
+                return false;
+        }
+        for (int i = 0; i < a->length; i++) {
+                if (SnakeCell(a, i) != SnakeCell(b, i)) {
+                        return false;
+                }
+        }
+        return memcmp(a->occupied, b->occupied, sizeof(uint64_t) * a->words) == 0
+                && memcmp(a->freeTree, b->freeTree, sizeof(int) * (a->blocks + 1)) == 0
+                && memcmp(&game->rng, &reference->rng, sizeof(Random)) == 0
+                && game->blueDot.x == reference->blueDot.x && game->blueDot.y == reference->blueDot.y
+                && game->moves == reference->moves && game->canMove == reference->canMove
+                && game->gameOver == reference->gameOver && game->gameWon == reference->gameWon;
+}
+
+// Function to play one rollout of each kind from the position and check that the position comes back
+bool CheckRollouts(BenchContext* c) {
+        SaveGameSnapshot(&c->snapshot, &c->root);
+        PlayRandom(&c->root, &c->policy, NULL);
+        RestoreGameSnapshot(&c->root, &c->snapshot);
+        bool snapshotSame = SamePosition(&c->root, &c->reference);
+        PlayRandom(&c->root, &c->policy, &c->log);
+        UndoMoves(&c->root, &c->log, rolloutMoves);
+        return snapshotSame && SamePosition(&c->root, &c->reference);
+}
+
+// Function to run a benchmark with more and more operations until it takes long enough, then print it
+void Run(const char* name, double (*bench)(BenchContext*, long long), BenchContext* c) {
+        double seconds;
+        long long ops = RunLongEnough(bench, c, &seconds);
+        printf("%s,%dx%d,%d,%lld,%.1f,%.0f\n", name, c->root.snake.width, c->root.snake.height, c->root.snake.length, ops, seconds * 1e9 / ops, ops / seconds);
+}
+
+int main(int argc, char** argv) {
+        if (argc > 1 && atoi(argv[1]) > 0) {
+                rolloutMoves = atoi(argv[1]);
+        }
+
+        int failed = 0;
+        printf("bench,board,length,ops,ns_per_op,ops_per_s\n");
+        for (int i = 0; i < (int)(sizeof(POSITIONS) / sizeof(POSITIONS[0])); i++) {
+                BenchContext* c = new BenchContext;
+                BuildGame(&c->root, POSITIONS[i][0], POSITIONS[i][1], POSITIONS[i][2]);
+                InitGameOfSize(&c->scratch, 1, POSITIONS[i][0], POSITIONS[i][1]);
+                InitGameOfSize(&c->reference, 1, POSITIONS[i][0], POSITIONS[i][1]);
+                CopyGame(&c->reference, &c->root);
+                InitGameSnapshot(&c->snapshot);
+                InitUndoLog(&c->log, rolloutMoves);
+                SeedRandom(&c->policy, 1);
+                bool same = CheckRollouts(c);
+
+                Run("CopyGame", TimeCopyGame, c);
+                Run("SaveGameSnapshot", TimeSaveSnapshot, c);
+                Run("RestoreGameSnapshot", TimeRestoreSnapshot, c);
+                Run("RolloutCopyGame", TimeRolloutCopy, c);
+                Run("RolloutSnapshot", TimeRolloutSnapshot, c);
+                Run("RolloutUndo", TimeRolloutUndo, c);
+                // The timed rollouts went back to the position many times, it has to be the same once more
+                same = same && CheckRollouts(c) && SamePosition(&c->root, &c->reference);
+                if (!same) {
+                        fprintf(stderr, "%dx%d length %d: the restored position differs from the CopyGame one\n", POSITIONS[i][0], POSITIONS[i][1], POSITIONS[i][2]);
+                        failed = 1;
+                }
+
+                FreeUndoLog(&c->log);
+                FreeGameSnapshot(&c->snapshot);
+                FreeGame(&c->reference);
+                FreeGame(&c->scratch);
+                FreeGame(&c->root);
+                delete c;
+        }
+        return failed;
+}
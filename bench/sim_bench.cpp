@@ -0,0 +1,43 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// sim_bench: runs the game rules headless with a random player and reports moves per second
+//
+// build: g++ -O2 bench/sim_bench.cpp game.cpp -o sim_bench
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<chrono>
+
+#include"../game.h"
+
+int main(int argc, char** argv) {
+        long long ticks = argc > 1 ? atoll(argv[1]) : 10000000;
+        srand(1);
+
+        long long games = 1;
+        long long eaten = 0;
+        Game game;
+        InitGame(&game, 1);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < ticks; i++) {
+                // turn in a random direction every few moves, illegal turns are ignored by the rules
+                int action = rand() % 4 == 0 ? rand() % 4 : ACTION_NONE;
+                int result = StepGame(&game, action);
+                if (result & STEP_ATE) {
+                        eaten++;
+                }
+                if (game.gameOver) {
+                        ResetGame(&game, games);
+                        games++;
+                }
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+
+        printf("moves: %lld, games: %lld, dots eaten: %lld\n", ticks, games, eaten);
+        printf("%.0f moves/s, %.1f ns/move\n", ticks / seconds, seconds * 1e9 / ticks);
+
+        FreeGame(&game);
+        return 0;
+}
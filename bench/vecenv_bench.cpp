@@ -0,0 +1,60 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// vecenv_bench: steps many games at once on 1, 2, 4, ... threads and reports game moves per second
+//
+// build: g++ -O2 -pthread bench/vecenv_bench.cpp vecenv.cpp game.cpp threadpool.cpp -o vecenv_bench
+// usage: vecenv_bench [games] [steps] [max threads]
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<chrono>
+#include<thread>
+
+#include"../vecenv.h"
+
+#define ACTION_ROWS 64 // number of prepared action rows, the steps cycle through them
+
+int main(int argc, char** argv) {
+        int games = argc > 1 ? atoi(argv[1]) : 4096;
+        int steps = argc > 2 ? atoi(argv[2]) : 2000;
+        int maxThreads = argc > 3 ? atoi(argv[3]) : (int)std::thread::hardware_concurrency();
+        if (maxThreads <= 0) {
+                maxThreads = 1;
+        }
+
+        // Random actions are prepared up front, so the main thread does not generate them during the timing
+        int* actions = new int[(size_t)ACTION_ROWS * games];
+        srand(1);
+        for (int i = 0; i < ACTION_ROWS * games; i++) {
+                actions[i] = rand() % 4 == 0 ? rand() % 4 : ACTION_NONE;
+        }
+
+        printf("games,threads,steps,env_steps_per_s,speedup,episodes\n");
+        double single = 0;
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+                VecEnv env;
+                InitVecEnv(&env, games, threads, 1);
+                long long episodes = 0;
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                for (int step = 0; step < steps; step++) {
+                        StepVecEnv(&env, actions + (size_t)(step % ACTION_ROWS) * games);
+                        for (int i = 0; i < games; i++) {
+                                episodes += env.done[i];
+                        }
+                }
+                std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+                double seconds = std::chrono::duration<double>(end - start).count();
+                double rate = (double)games * steps / seconds;
+                if (threads == 1) {
+                        single = rate;
+                }
+                printf("%d,%d,%d,%.0f,%.2f,%lld\n", games, threads, steps, rate, rate / single, episodes);
+                FreeVecEnv(&env);
+                if (threads < maxThreads && threads * 2 > maxThreads) {
+                        threads = maxThreads / 2;
+                }
+        }
+
+        delete[] actions;
+        return 0;
+}
@@ -0,0 +1,367 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// draw: drawing the game board, the snake and the text on SDL surfaces
+
+#include<stddef.h>
+#include<string.h>
+
+#include"draw.h"
+
+// --------------
+// DRAW FUNCTIONS
+// --------------
+
+// draw a text txt on surface screen, starting from the point (x, y)
+// charset is a 128x128 bitmap containing character images
+void DrawString(SDL_Surface* screen, int x, int y, const char* text, SDL_Surface* charset) {
+        int px, py, c;
+        SDL_Rect s, d;
+        s.w = 8;
+        s.h = 8;
+        d.w = 8;
+        d.h = 8;
+        while (*text) {
+                c = *text & 255;
+                px = (c % 16) * 8;
+                py = (c / 16) * 8;
+                s.x = px;
+                s.y = py;
+                d.x = x;
+                d.y = y;
+                SDL_BlitSurface(charset, &s, screen, &d);
+                x += 8;
+                text++;
+        }
+}
+
+// draw a surface sprite on a surface screen in point (x, y)
+// (x, y) is the center of sprite on screen
+void DrawSurface(SDL_Surface* screen, SDL_Surface* sprite, int x, int y) {
+        SDL_Rect dest;
+        dest.x = x - sprite->w / 2;
+        dest.y = y - sprite->h / 2;
+        dest.w = sprite->w;
+        dest.h = sprite->h;
+        SDL_BlitSurface(sprite, NULL, screen, &dest);
+}
+
+// describe a 32-bit surface as a target for the raster functions
+RasterTarget SurfaceTarget(SDL_Surface* surface) {
+        RasterTarget target;
+        target.pixels = (uint32_t*)surface->pixels;
+        target.pitch = surface->pitch / 4;
+        target.w = surface->w;
+        target.h = surface->h;
+        return target;
+}
+
+// draw a single pixel, pixels outside the surface are skipped
+void DrawPixel(SDL_Surface* surface, int x, int y, Uint32 color) {
+        if (x < 0 || x >= surface->w || y < 0 || y >= surface->h) {
+                return;
+        }
+        Uint8* p = (Uint8*)surface->pixels + y * surface->pitch + x * 4;
+        *(Uint32*)p = color;
+}
+
+// draw a vertical (when dx = 0, dy = 1) or horizontal (when dx = 1, dy = 0) line
+// horizontal and vertical lines are filled as whole spans, clipped to the surface
+void DrawLine(SDL_Surface* screen, int x, int y, int l, int dx, int dy, Uint32 color) {
+        RasterTarget target = SurfaceTarget(screen);
+        if (dx == 1 && dy == 0) {
+                RasterHLine(&target, x, y, l, color);
+                return;
+        }
+        if (dx == 0 && dy == 1) {
+                RasterVLine(&target, x, y, l, color);
+                return;
+        }
+        for (int i = 0; i < l; i++) {
+                DrawPixel(screen, x, y, color);
+                x += dx;
+                y += dy;
+        }
+}
+
+// draw a rectangle of size l by k, the outline and the fill are drawn in one pass clipped to the surface
+void DrawRectangle(SDL_Surface* screen, int x, int y, int l, int k, Uint32 outlineColor, Uint32 fillColor) {
+        RasterTarget target = SurfaceTarget(screen);
+        RasterRectangle(&target, x, y, l, k, outlineColor, fillColor);
+}
+
+// Function to draw the dot on the game board, a dot outside the view is not drawn
+// dotSurface has the size of a cell, so it is copied without scaling
+void DrawDot(SDL_Surface* screen, SDL_Surface* dotSurface, Dot* blueDot, Camera* camera) {
+        if (!CellVisible(camera, blueDot->x, blueDot->y)) {
+                return;
+        }
+        SDL_Rect dest;
+        dest.x = CellScreenX(camera, blueDot->x);
+        dest.y = CellScreenY(camera, blueDot->y);
+        dest.w = CELL_SIZE;
+        dest.h = CELL_SIZE;
+        SDL_BlitSurface(dotSurface, NULL, screen, &dest);
+}
+
+// Function to draw the grey grid over the visible cells of the game board
+// The camera moves by whole cells, so the grid only depends on how many cells are visible
+void DrawGrid(SDL_Surface* screen, Camera* camera, Uint32 gridColor) {
+        int width = camera->columns * CELL_SIZE;
+        int height = camera->rows * CELL_SIZE;
+        // vertical lines
+        for (int x = 0; x <= width; x += CELL_SIZE) {
+                DrawLine(screen, x, INFO_AREA_HEIGHT, height, 0, 1, gridColor);
+        }
+        // horizontal lines
+        for (int y = INFO_AREA_HEIGHT; y <= INFO_AREA_HEIGHT + height; y += CELL_SIZE) {
+                DrawLine(screen, 0, y, width, 1, 0, gridColor);
+        }
+}
+
+// Function to draw the visible part of the snake, the head is drawn last so it stays on top
+// A snake shorter than the view is drawn by its segments, a longer one by the visible cells it takes,
+// so the cost is bounded by the view and not by the length of the snake or the size of the board
+void DrawSnake(SDL_Surface* screen, Snake* snake, Camera* camera, Uint32 headColor, Uint32 bodyColor, Uint32 borderColor) {
+        if (snake->length <= camera->columns * camera->rows) {
+                for (int i = snake->length - 1; i > 0; i--) {
+                        Segment segment = SnakeSegment(snake, i);
+                        if (CellVisible(camera, segment.x, segment.y)) {
+                                // Draw the rest of the snake (bodyColor)
+                                DrawRectangle(screen, CellScreenX(camera, segment.x), CellScreenY(camera, segment.y), CELL_SIZE, CELL_SIZE, borderColor, bodyColor);
+                        }
+                }
+        }
+        else {
+                for (int y = camera->y; y < camera->y + camera->rows; y++) {
+                        int cell = CellIndex(snake->width, camera->x, y);
+                        for (int x = camera->x; x < camera->x + camera->columns; x++, cell++) {
+                                if (CellBit(snake->occupied, cell)) {
+                                        DrawRectangle(screen, CellScreenX(camera, x), CellScreenY(camera, y), CELL_SIZE, CELL_SIZE, borderColor, bodyColor);
+                                }
+                        }
+                }
+        }
+        // Draw the head of the snake (headColor)
+        Segment head = SnakeSegment(snake, 0);
+        if (CellVisible(camera, head.x, head.y)) {
+                DrawRectangle(screen, CellScreenX(camera, head.x), CellScreenY(camera, head.y), CELL_SIZE, CELL_SIZE, borderColor, headColor);
+        }
+}
+
+// ----------------
+// CAMERA FUNCTIONS
+// ----------------
+
+// Function to keep the start of the view between 0 and the last position that still shows the end of the board
+static int ClampView(int position, int visible, int size) {
+        if (position > size - visible) {
+                position = size - visible;
+        }
+        return position > 0 ? position : 0;
+}
+
+// Function to set up the camera over a board and center it on the head
+void InitCamera(Camera* camera, int width, int height, Segment* head) {
+        camera->width = width;
+        camera->height = height;
+        camera->columns = width < VIEW_COLUMNS ? width : VIEW_COLUMNS;
+        camera->rows = height < VIEW_ROWS ? height : VIEW_ROWS;
+        camera->x = ClampView(head->x - camera->columns / 2, camera->columns, width);
+        camera->y = ClampView(head->y - camera->rows / 2, camera->rows, height);
+}
+
+// Function to move one axis of the view just enough to keep the head margin cells inside it
+static int FollowAxis(int position, int head, int visible, int size) {
+        int margin = CAMERA_MARGIN < (visible - 1) / 2 ? CAMERA_MARGIN : (visible - 1) / 2;
+        if (head < position + margin) {
+                position = head - margin;
+        }
+        else if (head > position + visible - 1 - margin) {
+                position = head - (visible - 1 - margin);
+        }
+        return ClampView(position, visible, size);
+}
+
+// Function to make the camera follow the head
+bool FollowHead(Camera* camera, Segment* head) {
+        int x = FollowAxis(camera->x, head->x, camera->columns, camera->width);
+        int y = FollowAxis(camera->y, head->y, camera->rows, camera->height);
+        bool moved = x != camera->x || y != camera->y;
+        camera->x = x;
+        camera->y = y;
+        return moved;
+}
+
+// Function to check if the cell (x, y) of the board is in the view
+bool CellVisible(Camera* camera, int x, int y) {
+        return x >= camera->x && x < camera->x + camera->columns && y >= camera->y && y < camera->y + camera->rows;
+}
+
+// Function to get the x coordinate on the screen of a column of the board
+int CellScreenX(Camera* camera, int x) {
+        return (x - camera->x) * CELL_SIZE;
+}
+
+// Function to get the y coordinate on the screen of a row of the board
+int CellScreenY(Camera* camera, int y) {
+        return INFO_AREA_HEIGHT + (y - camera->y) * CELL_SIZE;
+}
+
+// --------------------
+// BACKGROUND FUNCTIONS
+// --------------------
+
+// Function to initialize an empty background cache
+void InitBackground(BackgroundCache* cache) {
+        cache->surface = NULL;
+        cache->valid = 0;
+}
+
+// Function to draw the static layer into the cache, it is redrawn only when the colors, the screen size or the visible cells change
+// Returns true when the static layer was redrawn and the whole screen has to be restored from it
+bool PrepareBackground(BackgroundCache* cache, SDL_Surface* screen, Camera* camera, Uint32 outlineColor, Uint32 infoColor, Uint32 boardColor, Uint32 gridColor) {
+        if (cache->valid && cache->surface->w == screen->w && cache->surface->h == screen->h
+                && cache->columns == camera->columns && cache->rows == camera->rows
+                && cache->outlineColor == outlineColor && cache->infoColor == infoColor
+                && cache->boardColor == boardColor && cache->gridColor == gridColor) {
+                return false;
+        }
+        if (cache->surface == NULL || cache->surface->w != screen->w || cache->surface->h != screen->h) {
+                SDL_FreeSurface(cache->surface);
+                cache->surface = SDL_CreateRGBSurface(0, screen->w, screen->h, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+                // The cache is copied over the screen as it is, without alpha blending
+                SDL_SetSurfaceBlendMode(cache->surface, SDL_BLENDMODE_NONE);
+        }
+        SDL_FillRect(cache->surface, NULL, boardColor);
+        DrawRectangle(cache->surface, 0, 0, SCREEN_WIDTH, INFO_AREA_HEIGHT, outlineColor, infoColor);
+        DrawRectangle(cache->surface, 0, INFO_AREA_HEIGHT, SCREEN_WIDTH, GAME_BOARD_HEIGHT, outlineColor, boardColor);
+        DrawGrid(cache->surface, camera, gridColor);
+        cache->columns = camera->columns;
+        cache->rows = camera->rows;
+        cache->outlineColor = outlineColor;
+        cache->infoColor = infoColor;
+        cache->boardColor = boardColor;
+        cache->gridColor = gridColor;
+        cache->valid = 1;
+        return true;
+}
+
+// Function to copy a part of the static layer back onto the screen (NULL restores the whole screen)
+void RestoreBackground(SDL_Surface* screen, BackgroundCache* cache, SDL_Rect* rect) {
+        if (rect == NULL) {
+                SDL_BlitSurface(cache->surface, NULL, screen, NULL);
+                return;
+        }
+        SDL_Rect dest = *rect;
+        SDL_BlitSurface(cache->surface, rect, screen, &dest);
+}
+
+// Function to free the cached static layer
+void FreeBackground(BackgroundCache* cache) {
+        SDL_FreeSurface(cache->surface);
+        cache->surface = NULL;
+        cache->valid = 0;
+}
+
+// --------------
+// TEXT FUNCTIONS
+// --------------
+
+// Function to prepare the glyph atlas: the font in the pixel format of the screen, converted once if it has another one
+// Blits between surfaces of one format only compare the color key, no pixel is converted
+bool InitTextCache(TextCache* cache, SDL_Surface* charset, SDL_Surface* screen) {
+        cache->pixelFormat = screen->format->format;
+        cache->keyColor = SDL_MapRGB(screen->format, 0x00, 0x00, 0x00);
+        cache->ownsAtlas = charset->format->format != cache->pixelFormat;
+        cache->atlas = cache->ownsAtlas ? SDL_ConvertSurface(charset, screen->format, 0) : charset;
+        for (int i = 0; i < TEXT_LINES; i++) {
+                cache->lines[i].surface = NULL;
+                cache->lines[i].text[0] = '\0';
+                cache->lines[i].key = 0;
+                cache->lines[i].valid = 0;
+        }
+        if (cache->atlas == NULL) {
+                return false;
+        }
+        // The glyphs are copied as they are, black is the only transparent color
+        SDL_SetSurfaceBlendMode(cache->atlas, SDL_BLENDMODE_NONE);
+        SDL_SetColorKey(cache->atlas, true, cache->keyColor);
+        return true;
+}
+
+// Function to rasterize a text into a line: one glyph blit per character now, one blit of the whole line later
+void SetTextLine(TextCache* cache, int line, const char* text) {
+        TextLine* cached = &cache->lines[line];
+        if (cached->valid && strcmp(cached->text, text) == 0) {
+                return;
+        }
+        int length = (int)strlen(text);
+        if (length >= TEXT_LENGTH) {
+                length = TEXT_LENGTH - 1;
+        }
+        memcpy(cached->text, text, length);
+        cached->text[length] = '\0';
+        cached->valid = 1;
+        if (cached->surface != NULL && cached->surface->w != length * 8) {
+                SDL_FreeSurface(cached->surface);
+                cached->surface = NULL;
+        }
+        if (length == 0) {
+                return;
+        }
+        if (cached->surface == NULL) {
+                cached->surface = SDL_CreateRGBSurfaceWithFormat(0, length * 8, 8, 32, cache->pixelFormat);
+                if (cached->surface == NULL) {
+                        return;
+                }
+                SDL_SetSurfaceBlendMode(cached->surface, SDL_BLENDMODE_NONE);
+                SDL_SetColorKey(cached->surface, true, cache->keyColor);
+        }
+        SDL_FillRect(cached->surface, NULL, cache->keyColor);
+        DrawString(cached->surface, 0, 0, cached->text, cache->atlas);
+}
+
+// Function to check the key a dynamic line was formatted from and remember the new one
+bool TextLineOutdated(TextCache* cache, int line, long long key) {
+        TextLine* cached = &cache->lines[line];
+        if (cached->valid && cached->key == key) {
+                return false;
+        }
+        cached->key = key;
+        return true;
+}
+
+// Function to draw a cached line of text
+void DrawTextLine(SDL_Surface* screen, TextCache* cache, int line, int x, int y) {
+        SDL_Surface* surface = cache->lines[line].surface;
+        if (surface == NULL) {
+                return;
+        }
+        SDL_Rect dest;
+        dest.x = x;
+        dest.y = y;
+        dest.w = surface->w;
+        dest.h = surface->h;
+        SDL_BlitSurface(surface, NULL, screen, &dest);
+}
+
+// Function to draw a cached line of text in the middle of the screen
+void DrawTextLineCentered(SDL_Surface* screen, TextCache* cache, int line, int y) {
+        SDL_Surface* surface = cache->lines[line].surface;
+        if (surface != NULL) {
+                DrawTextLine(screen, cache, line, screen->w / 2 - surface->w / 2, y);
+        }
+}
+
+// Function to free the atlas and all the cached lines
+void FreeTextCache(TextCache* cache) {
+        for (int i = 0; i < TEXT_LINES; i++) {
+                SDL_FreeSurface(cache->lines[i].surface);
+                cache->lines[i].surface = NULL;
+                cache->lines[i].valid = 0;
+        }
+        if (cache->ownsAtlas) {
+                SDL_FreeSurface(cache->atlas);
+        }
+        cache->atlas = NULL;
+}
@@ -0,0 +1,134 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// draw: drawing the game board, the snake and the text on SDL surfaces
+
+#ifndef DRAW_H
+#define DRAW_H
+
+extern "C" {
+#include"./SDL2-2.0.10/include/SDL.h"
+}
+
+#include"game.h"
+#include"raster.h"
+
+// ------------------
+// DEFINING CONSTANTS
+// ------------------
+
+#define SCREEN_WIDTH 640 // pixels
+#define SCREEN_HEIGHT 440 // pixels
+
+#define INFO_AREA_HEIGHT (SCREEN_HEIGHT / 11) // The height of the area where all the information is displayed
+#define GAME_BOARD_HEIGHT (SCREEN_HEIGHT - INFO_AREA_HEIGHT) // The height of the game board
+
+#define CELL_SIZE       20 // The size of a single cell in the game board, ROW_CELLS * CELL_SIZE fills the screen width
+
+#define VIEW_COLUMNS (SCREEN_WIDTH / CELL_SIZE) // The most cells of a row shown on the screen
+#define VIEW_ROWS (GAME_BOARD_HEIGHT / CELL_SIZE) // The most cells of a column shown on the screen
+#define CAMERA_MARGIN 5 // The camera moves when the head comes closer than this many cells to the edge of the view
+
+#define TEXT_LINES 16 // How many lines of text a TextCache keeps
+#define TEXT_LENGTH 128 // The longest line of text, with the terminating zero
+
+// -------------------
+// DEFINING STRUCTURES
+// -------------------
+
+// The part of the board shown on the screen, it moves by whole cells so the grid always stays in place
+struct Camera {
+        int x; // the cell of the board in the top left corner of the view
+        int y;
+        int columns; // the number of cells shown, less than the view when the board is smaller
+        int rows;
+        int width; // the size of the board in cells
+        int height;
+};
+
+struct BackgroundCache {
+        SDL_Surface* surface; // the static layer of the screen: info bar, board background and grid
+        int columns; // the size of the grid in the static layer
+        int rows;
+        Uint32 outlineColor; // the colors the static layer was drawn with
+        Uint32 infoColor;
+        Uint32 boardColor;
+        Uint32 gridColor;
+        int valid; // the surface holds an up to date static layer
+};
+
+// A line of text rasterized once, it is drawn again only when its text changes
+struct TextLine {
+        SDL_Surface* surface; // the rendered text with a color key, NULL for an empty line
+        char text[TEXT_LENGTH]; // the text in the surface
+        long long key; // the value a dynamic line was formatted from
+        int valid; // the line holds a rendered text
+};
+
+struct TextCache {
+        SDL_Surface* atlas; // the font in the pixel format of the screen
+        int ownsAtlas; // the atlas is a converted copy of the font, freed with the cache
+        Uint32 pixelFormat; // the pixel format of the screen
+        Uint32 keyColor; // black in the pixel format of the screen, the transparent color of the text
+        TextLine lines[TEXT_LINES];
+};
+
+// --------------
+// DRAW FUNCTIONS
+// --------------
+
+void DrawString(SDL_Surface* screen, int x, int y, const char* text, SDL_Surface* charset);
+void DrawSurface(SDL_Surface* screen, SDL_Surface* sprite, int x, int y);
+RasterTarget SurfaceTarget(SDL_Surface* surface);
+void DrawPixel(SDL_Surface* surface, int x, int y, Uint32 color);
+void DrawLine(SDL_Surface* screen, int x, int y, int l, int dx, int dy, Uint32 color);
+void DrawRectangle(SDL_Surface* screen, int x, int y, int l, int k, Uint32 outlineColor, Uint32 fillColor);
+void DrawDot(SDL_Surface* screen, SDL_Surface* dotSurface, Dot* blueDot, Camera* camera);
+void DrawGrid(SDL_Surface* screen, Camera* camera, Uint32 gridColor);
+void DrawSnake(SDL_Surface* screen, Snake* snake, Camera* camera, Uint32 headColor, Uint32 bodyColor, Uint32 borderColor);
+
+// ----------------
+// CAMERA FUNCTIONS
+// ----------------
+
+// show the part of a width x height board around the head, a board smaller than the view is shown whole
+void InitCamera(Camera* camera, int width, int height, Segment* head);
+
+// move the view by whole cells to keep the head away from its edges, returns true when it moved and the board has to be drawn again
+bool FollowHead(Camera* camera, Segment* head);
+
+bool CellVisible(Camera* camera, int x, int y);
+
+// the top left pixel of the cell (x, y) of the board on the screen
+int CellScreenX(Camera* camera, int x);
+int CellScreenY(Camera* camera, int y);
+
+// --------------------
+// BACKGROUND FUNCTIONS
+// --------------------
+
+void InitBackground(BackgroundCache* cache);
+bool PrepareBackground(BackgroundCache* cache, SDL_Surface* screen, Camera* camera, Uint32 outlineColor, Uint32 infoColor, Uint32 boardColor, Uint32 gridColor);
+void RestoreBackground(SDL_Surface* screen, BackgroundCache* cache, SDL_Rect* rect);
+void FreeBackground(BackgroundCache* cache);
+
+// --------------
+// TEXT FUNCTIONS
+// --------------
+
+// draw from charset when it has the format of screen, otherwise from a converted copy, the surfaces drawn with the cache need the same format
+// charset has to live as long as the cache
+bool InitTextCache(TextCache* cache, SDL_Surface* charset, SDL_Surface* screen);
+
+// put the text into a line, it is rasterized only when it differs from the text the line already has
+void SetTextLine(TextCache* cache, int line, const char* text);
+
+// true when a dynamic line was made from another key than this one, the key is then stored and the line has to be set again
+bool TextLineOutdated(TextCache* cache, int line, long long key);
+
+// draw a line with its top left corner at (x, y) or centered on the screen
+void DrawTextLine(SDL_Surface* screen, TextCache* cache, int line, int x, int y);
+void DrawTextLineCentered(SDL_Surface* screen, TextCache* cache, int line, int y);
+
+void FreeTextCache(TextCache* cache);
+
+#endif
@@ -0,0 +1,930 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// game: the rules of the game, without SDL, so they can also run headless
+
+#include<string.h>
+#include<type_traits>
+#if defined(_MSC_VER)
+#include<intrin.h>
+#endif
+
+#include"game.h"
+
+// ----------------
+// RANDOM FUNCTIONS
+// ----------------
+
+// Function to fill the state of the generator from a single number (splitmix64), the state is never all zeros
+void SeedRandom(Random* rng, uint64_t seed) {
+        for (int i = 0; i < 4; i++) {
+                seed += 0x9E3779B97F4A7C15ULL;
+                uint64_t z = seed;
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                rng->state[i] = z ^ (z >> 31);
+        }
+}
+
+// Function to rotate the bits of x left by k
+static uint64_t RotateLeft(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+}
+
+// Function to get the next random number (xoshiro256**)
+uint64_t NextRandom(Random* rng) {
+        uint64_t* s = rng->state;
+        uint64_t result = RotateLeft(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = RotateLeft(s[3], 45);
+        return result;
+}
+
+// Function to get a random number from 0 to n - 1 (the top 32 bits scaled to n, without a division)
+uint32_t RandomBelow(Random* rng, uint32_t n) {
+        return (uint32_t)(((NextRandom(rng) >> 32) * n) >> 32);
+}
+
+// ---------------
+// BOARD FUNCTIONS
+// ---------------
+
+// Function to get the i-th segment of the snake (0 is the head, length - 1 is the tail)
+// The body only keeps cell indices, the head is kept as x, y too
+Segment SnakeSegment(Snake* snake, int i) {
+        if (i == 0) {
+                return snake->headSegment;
+        }
+        int cell = SnakeCell(snake, i);
+        Segment segment;
+        segment.x = cell % snake->width;
+        segment.y = cell / snake->width;
+        return segment;
+}
+
+// Function to get the cell index of the i-th segment of the snake, -1 for a head off the board
+int SnakeCell(Snake* snake, int i) {
+        int index = snake->head - i;
+        if (index < 0) {
+                index += snake->capacity;
+        }
+        return snake->body[index];
+}
+
+// Function to get the index of the cell (x, y) on a board of the given width
+int CellIndex(int width, int x, int y) {
+        return y * width + x;
+}
+
+// Function to check if the cell (x, y) lies on a board of width x height cells
+bool InsideBoard(int width, int height, int x, int y) {
+        return x >= 0 && x < width && y >= 0 && y < height;
+}
+
+// Function to check if a board of width x height cells can be played
+bool BoardSizeAllowed(int width, int height) {
+        return width >= MIN_BOARD_SIZE && height >= MIN_BOARD_SIZE && (long long)width * height <= MAX_BOARD_CELLS;
+}
+
+// Function to read the bit of a cell in an occupancy bitset
+bool CellBit(const uint64_t* bits, int cell) {
+        return ((bits[cell >> 6] >> (cell & 63)) & 1) != 0;
+}
+
+// Function to check if the cell (x, y) is taken by the snake, cells outside the board count as taken
+bool CellOccupied(Snake* snake, int x, int y) {
+        if (!InsideBoard(snake->width, snake->height, x, y)) {
+                return true;
+        }
+        return CellBit(snake->occupied, CellIndex(snake->width, x, y));
+}
+
+// Function to count the set bits of a word
+// Without the popcnt instruction the bits are added in pairs, nibbles and bytes, which beats the library call
+static int CountBits(uint64_t bits) {
+#if defined(__POPCNT__)
+        return __builtin_popcountll(bits);
+#else
+        bits = bits - ((bits >> 1) & 0x5555555555555555ULL);
+        bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+        bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (int)((bits * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Function to get the position of the rank-th set bit of a word, the word has more than rank bits set
+// The halves holding it are found by counting down to a byte, the last few bits below it are cleared one by one
+static int SelectBit(uint64_t bits, int rank) {
+        int position = 0;
+        for (int width = 32; width >= 8; width /= 2) {
+                int low = CountBits(bits & (((uint64_t)1 << width) - 1));
+                if (rank >= low) {
+                        rank -= low;
+                        bits >>= width;
+                        position += width;
+                }
+        }
+        for (int i = 0; i < rank; i++) {
+                bits &= bits - 1;
+        }
+#if defined(_MSC_VER)
+        unsigned long lowest;
+        _BitScanForward64(&lowest, bits);
+        return position + (int)lowest;
+#else
+        return position + __builtin_ctzll(bits);
+#endif
+}
+
+// Function to find the rank-th free cell of a bitset by counting the free cells of every word
+int SelectFreeCell(const uint64_t* occupied, int words, int rank) {
+        for (int word = 0; word < words; word++) {
+                int free = 64 - CountBits(occupied[word]);
+                if (rank < free) {
+                        return word * 64 + SelectBit(~occupied[word], rank);
+                }
+                rank -= free;
+        }
+        return -1;
+}
+
+// Function to add delta free cells to a block of the occupancy bitset in the Fenwick tree
+static void AddFreeCells(Snake* snake, int block, int delta) {
+        for (int i = block + 1; i <= snake->blocks; i += i & -i) {
+                snake->freeTree[i] += delta;
+        }
+        snake->freeCount += delta;
+}
+
+// Function to find the rank-th free cell of the snake's board in logarithmic time
+// The Fenwick tree is descended to the block holding it, the cell is then picked out of the words of that block
+static int FindFreeCell(Snake* snake, int rank) {
+        int block = 0;
+        int step = 1;
+        while (step * 2 <= snake->blocks) {
+                step *= 2;
+        }
+        for (; step > 0; step /= 2) {
+                if (block + step <= snake->blocks && snake->freeTree[block + step] <= rank) {
+                        block += step;
+                        rank -= snake->freeTree[block];
+                }
+        }
+        int word = block * FREE_BLOCK_WORDS;
+        int words = snake->words - word < FREE_BLOCK_WORDS ? snake->words - word : FREE_BLOCK_WORDS;
+        return word * 64 + SelectFreeCell(snake->occupied + word, words, rank);
+}
+
+// Function to take a cell for the snake, returns false when the snake already takes it
+static bool OccupyCell(Snake* snake, int cell) {
+        uint64_t bit = (uint64_t)1 << (cell & 63);
+        if (snake->occupied[cell >> 6] & bit) {
+                return false;
+        }
+        snake->occupied[cell >> 6] |= bit;
+        AddFreeCells(snake, cell / FREE_BLOCK_CELLS, -1);
+        return true;
+}
+
+// Function to give a cell of the snake back to the free cells
+static void ReleaseCell(Snake* snake, int cell) {
+        snake->occupied[cell >> 6] &= ~((uint64_t)1 << (cell & 63));
+        AddFreeCells(snake, cell / FREE_BLOCK_CELLS, 1);
+}
+
+// Function to get the number of 64 bit words of the board memory: the bitset and then the free cell tree
+static int BoardWords(Snake* snake) {
+        return snake->words + (snake->blocks + 2) / 2;
+}
+
+// Function to count the free cells of the bitset into the Fenwick tree again, after many cells changed at once
+// Every node of the tree starts as the number of free cells in its block and is then added to its parent
+static void BuildFreeTree(Snake* snake) {
+        memset(snake->freeTree, 0, sizeof(int) * (snake->blocks + 1));
+        snake->freeCount = 0;
+        for (int i = 0; i < snake->words; i++) {
+                int free = 64 - CountBits(snake->occupied[i]);
+                snake->freeTree[i / FREE_BLOCK_WORDS + 1] += free;
+                snake->freeCount += free;
+        }
+        for (int i = 1; i <= snake->blocks; i++) {
+                int parent = i + (i & -i);
+                if (parent <= snake->blocks) {
+                        snake->freeTree[parent] += snake->freeTree[i];
+                }
+        }
+}
+
+// Function to take (or give back) the collected bits of one word, bits already in that state are left alone
+// The change of the free cells is added to the tree only when the next word lies in another block
+static void ChangeWord(Snake* snake, int word, uint64_t mask, bool take, int* block, int* delta) {
+        uint64_t changed = take ? mask & ~snake->occupied[word] : mask & snake->occupied[word];
+        snake->occupied[word] ^= changed;
+        if (word / FREE_BLOCK_WORDS != *block) {
+                if (*delta != 0) {
+                        AddFreeCells(snake, *block, *delta);
+                }
+                *block = word / FREE_BLOCK_WORDS;
+                *delta = 0;
+        }
+        *delta += take ? -CountBits(changed) : CountBits(changed);
+}
+
+// Function to take (or give back) a list of cells, -1 is skipped
+// The segments of a snake mostly lie next to each other, so their bits are collected by words
+// and the tree is updated once for every run of cells in one block
+static void ChangeCells(Snake* snake, const int* cells, int count, bool take) {
+        int word = -1;
+        uint64_t mask = 0;
+        int block = -1;
+        int delta = 0;
+        for (int i = 0; i < count; i++) {
+                int cell = cells[i];
+                if (cell < 0) {
+                        continue;
+                }
+                if (cell >> 6 != word) {
+                        if (word >= 0) {
+                                ChangeWord(snake, word, mask, take, &block, &delta);
+                        }
+                        word = cell >> 6;
+                        mask = 0;
+                }
+                mask |= (uint64_t)1 << (cell & 63);
+        }
+        if (word >= 0) {
+                ChangeWord(snake, word, mask, take, &block, &delta);
+        }
+        if (delta != 0) {
+                AddFreeCells(snake, block, delta);
+        }
+}
+
+// Function to mark every cell of the board as free
+static void ClearBoard(Snake* snake) {
+        int cells = snake->width * snake->height;
+        memset(snake->occupied, 0, sizeof(uint64_t) * snake->words);
+        // The bits after the last cell are taken, so they are never drawn as free cells
+        if (cells % 64 != 0) {
+                snake->occupied[snake->words - 1] = ~(uint64_t)0 << (cells % 64);
+        }
+        BuildFreeTree(snake);
+}
+
+// Function to put a new snake in the middle of a cleared board
+static void PlaceSnake(Snake* snake) {
+        snake->length = SNAKE_LENGTH;
+        snake->head = snake->length - 1;
+        snake->tail = 0;
+        snake->grow = 0;
+        snake->collided = 0;
+        for (int i = 0; i < snake->length; i++) {
+                int cell = CellIndex(snake->width, snake->width / 2 - i, snake->height / 2);
+                snake->body[snake->head - i] = cell;
+                OccupyCell(snake, cell);
+        }
+        snake->headSegment.x = snake->width / 2;
+        snake->headSegment.y = snake->height / 2;
+        snake->direction = RIGHT;
+        snake->speed = 0.2; // move every x seconds
+}
+
+// Function to Initialize the snake in the middle of a board of width x height cells
+// The memory of the board is one bit per cell, the body starts small and grows with the snake
+void InitSnake(Snake* snake, int width, int height) {
+        snake->capacity = SNAKE_CAPACITY;
+        snake->body = new int[snake->capacity];
+        snake->width = width;
+        snake->height = height;
+        snake->words = (width * height + 63) / 64;
+        snake->blocks = (snake->words + FREE_BLOCK_WORDS - 1) / FREE_BLOCK_WORDS;
+        snake->occupied = new uint64_t[BoardWords(snake)];
+        snake->freeTree = (int*)(snake->occupied + snake->words);
+        ClearBoard(snake);
+        PlaceSnake(snake);
+}
+
+// Function to take the snake off its board
+// The cells of a snake shorter than the bitset are given back from the two pieces of the ring buffer, a longer snake
+// clears the whole board. A head that collided shares its cell with the segment it ran into, it is given back once
+static void ClearSnakeCells(Snake* snake) {
+        if (snake->length < snake->words) {
+                int first = snake->capacity - snake->tail;
+                if (first >= snake->length) {
+                        ChangeCells(snake, snake->body + snake->tail, snake->length, false);
+                }
+                else {
+                        ChangeCells(snake, snake->body + snake->tail, first, false);
+                        ChangeCells(snake, snake->body, snake->length - first, false);
+                }
+        }
+        else {
+                ClearBoard(snake);
+        }
+}
+
+// Function to put the snake back at the start without allocating
+void ResetSnake(Snake* snake) {
+        ClearSnakeCells(snake);
+        PlaceSnake(snake);
+}
+
+// Function to check if the snake can turn at the border
+// (x, y) is the position of the head, the cell next to it in the given direction has to be free
+bool canTurn(Snake* snake, int x, int y, int direction) {
+        return GridCanTurn(snake->occupied, snake->width, snake->height, x, y, direction);
+}
+
+// Function to check if the cell next to (x, y) in the given direction is free in an occupancy bitset
+bool GridCanTurn(const uint64_t* occupied, int width, int height, int x, int y, int direction) {
+        if (direction == DOWN) {
+                y++;
+        }
+        else if (direction == UP) {
+                y--;
+        }
+        else if (direction == RIGHT) {
+                x++;
+        }
+        else if (direction == LEFT) {
+                x--;
+        }
+        else {
+                return false;
+        }
+        return InsideBoard(width, height, x, y) && !CellBit(occupied, CellIndex(width, x, y));
+}
+
+// Function to add a segment to the snake when it eats the blue dot
+// The tail is not advanced on the next move, so the new segment appears where the tail was
+void growSnake(Snake* snake) {
+        snake->grow++;
+}
+
+// Function to speed up the snake after a certain time
+void SpeedUp(Snake* snake) {
+        snake->speed *= SPEEDUP;
+}
+
+// Function to move the head one cell in its direction
+// At the border the snake turns by itself, into the free side if it can, otherwise into the other one
+// occupied is the occupancy bitset of a width x height board without the tail cell that is about to be left
+void MoveHead(const uint64_t* occupied, int width, int height, Segment* head, int* direction) {
+        if (*direction == RIGHT) {
+                if (head->x == width - 1) {
+                        if (head->y < height - 1 && GridCanTurn(occupied, width, height, head->x, head->y, DOWN)) {
+                                *direction = DOWN;
+                                head->y++;
+                        }
+                        else {
+                                *direction = UP;
+                                head->y--;
+                        }
+                }
+                else {
+                        head->x++;
+                }
+        }
+        else if (*direction == LEFT) {
+                if (head->x == 0) {
+                        if (head->y > 0 && GridCanTurn(occupied, width, height, head->x, head->y, UP)) {
+                                *direction = UP;
+                                head->y--;
+                        }
+                        else {
+                                *direction = DOWN;
+                                head->y++;
+                        }
+                }
+                else {
+                        head->x--;
+                }
+        }
+        else if (*direction == UP) {
+                if (head->y == 0) {
+                        if (head->x < width - 1 && GridCanTurn(occupied, width, height, head->x, head->y, RIGHT)) {
+                                *direction = RIGHT;
+                                head->x++;
+                        }
+                        else {
+                                *direction = LEFT;
+                                head->x--;
+                        }
+                }
+                else {
+                        head->y--;
+                }
+        }
+        else if (*direction == DOWN) {
+                if (head->y == height - 1) {
+                        if (head->x > 0 && GridCanTurn(occupied, width, height, head->x, head->y, LEFT)) {
+                                *direction = LEFT;
+                                head->x--;
+                        }
+                        else {
+                                *direction = RIGHT;
+                                head->x++;
+                        }
+                }
+                else {
+                        head->y++;
+                }
+        }
+}
+
+// Function to move the body into a ring buffer twice as large, the tail goes to the first slot
+static void GrowBody(Snake* snake) {
+        int* body = new int[snake->capacity * 2];
+        for (int i = 0; i < snake->length; i++) {
+                body[i] = SnakeCell(snake, snake->length - 1 - i);
+        }
+        delete[] snake->body;
+        snake->body = body;
+        snake->capacity *= 2;
+        snake->tail = 0;
+        snake->head = snake->length - 1;
+}
+
+// Function to update the position of the snake
+// Only the new head is written and the tail index is advanced, so a move takes constant time
+// The Fenwick tree adds a logarithm of the board size, the body doubles when a growing snake fills it
+void UpdateSnake(Snake* snake) {
+        Segment head = snake->headSegment;
+        // Free the tail first, the head is allowed to move into the cell the tail leaves
+        if (snake->grow > 0) {
+                snake->grow--;
+                if (snake->length == snake->capacity) {
+                        GrowBody(snake);
+                }
+        }
+        else {
+                int tail = SnakeCell(snake, snake->length - 1);
+                if (tail >= 0) {
+                        ReleaseCell(snake, tail);
+                }
+                snake->tail++;
+                if (snake->tail == snake->capacity) {
+                        snake->tail = 0;
+                }
+                snake->length--;
+        }
+        MoveHead(snake->occupied, snake->width, snake->height, &head, &snake->direction);
+        snake->head++;
+        if (snake->head == snake->capacity) {
+                snake->head = 0;
+        }
+        snake->length++;
+        int cell = InsideBoard(snake->width, snake->height, head.x, head.y) ? CellIndex(snake->width, head.x, head.y) : -1;
+        snake->body[snake->head] = cell;
+        snake->headSegment = head;
+        // A head moving into the body leaves the cell to the segment already there, the game ends with it
+        if (cell >= 0 && !OccupyCell(snake, cell)) {
+                snake->collided = 1;
+        }
+}
+
+// The collision with the body was found by UpdateSnake, when the cell of the head was already taken
+bool checkCollision(Snake* snake) {
+        if (snake->body[snake->head] < 0) {
+                return true;
+        }
+        return snake->collided != 0;
+}
+
+// Function to free the memory of the snake, freeTree is a part of the memory of occupied
+void FreeSnake(Snake* snake) {
+        delete[] snake->body;
+        delete[] snake->occupied;
+}
+
+// -------------
+// DOT FUNCTIONS
+// -------------
+
+// Function to initialize the blue dot
+// The dot is drawn uniformly from the free cells, false is returned when the snake fills the whole board
+bool InitDot(Dot* blueDot, Snake* snake, Random* rng) {
+        if (snake->freeCount == 0) {
+                return false;
+        }
+        int cell = FindFreeCell(snake, (int)RandomBelow(rng, snake->freeCount));
+        blueDot->x = cell % snake->width;
+        blueDot->y = cell / snake->width;
+        return true;
+}
+
+// Function to check if the snake has eaten the blue dot
+bool checkDotCollision(Dot* blueDot, Snake* snake) {
+        if (snake->headSegment.x == blueDot->x && snake->headSegment.y == blueDot->y) {
+                return true;
+        }
+        return false;
+}
+
+// --------------
+// GAME FUNCTIONS
+// --------------
+
+// Function to set up the rules and the first dot of a game whose snake was just placed
+static void StartGame(Game* game, uint64_t seed) {
+        game->seed = seed;
+        SeedRandom(&game->rng, seed);
+        game->moves = 0;
+        InitDot(&game->blueDot, &game->snake, &game->rng);
+        game->worldTime = 0;
+        game->clockTime = 0;
+        game->lastMoveTime = 0;
+        game->nextSpeedupTime = SPEEDUP_TIME;
+        game->frameMoves = 0;
+        game->canMove = 0;
+        game->turnCount = 0;
+        game->gameOver = 0;
+        game->gameWon = 0;
+}
+
+// Function to start a new game on the default board
+void InitGame(Game* game, uint64_t seed) {
+        InitGameOfSize(game, seed, ROW_CELLS, COL_CELLS);
+}
+
+// Function to start a new game on a board of the given size
+void InitGameOfSize(Game* game, uint64_t seed, int width, int height) {
+        InitSnake(&game->snake, width, height);
+        StartGame(game, seed);
+}
+
+// Function to start a new game in the memory of the last one
+// Only the cells of the old snake are cleared, so a restart of a short game takes time of its length, not of the board
+void ResetGame(Game* game, uint64_t seed) {
+        ResetSnake(&game->snake);
+        StartGame(game, seed);
+}
+
+// Function to get the memory of a game: the Game, the ring buffer of the body and the bitset with the free cell tree
+size_t GameMemory(Game* game) {
+        return sizeof(Game) + sizeof(int) * (size_t)game->snake.capacity + sizeof(uint64_t) * (size_t)BoardWords(&game->snake);
+}
+
+// Function to turn the snake, the same way the arrow keys do
+// The snake turns at most once per move, never back into itself and never straight into the border
+bool TurnSnake(Game* game, int direction) {
+        Snake* snake = &game->snake;
+        if (game->gameOver || !game->canMove) {
+                return false;
+        }
+        if (!TurnAllowed(&snake->headSegment, snake->length + snake->grow, snake->direction, direction, snake->width, snake->height)) {
+                return false;
+        }
+        snake->direction = direction;
+        game->canMove = 0;
+        return true;
+}
+
+// Function to check if a snake with the given head, length and direction may turn into newDirection on a width x height board
+// It never turns back into itself (unless it is a single segment) and never straight into the border
+// length counts the growth still to come, so a snake of one segment that has just eaten cannot turn back any more
+bool TurnAllowed(Segment* head, int length, int direction, int newDirection, int width, int height) {
+        if (newDirection == RIGHT && (direction != LEFT || length == 1)) {
+                return head->x < width - 1;
+        }
+        else if (newDirection == LEFT && (direction != RIGHT || length == 1)) {
+                return head->x > 0;
+        }
+        else if (newDirection == UP && (direction != DOWN || length == 1)) {
+                return head->y > 0;
+        }
+        else if (newDirection == DOWN && (direction != UP || length == 1)) {
+                return head->y < height - 1;
+        }
+        return false;
+}
+
+// Function to get the opposite of a direction
+static int OppositeDirection(int direction) {
+        return direction ^ 1;
+}
+
+// Function to add a turn to the queue
+// Each turn is checked against the direction the snake faces after the turns before it, so two quick presses
+// (like up and then left while going right) are both kept. The border is checked when the turn is made:
+// a turn TurnSnake rejects then (straight into the border) is dropped and the turns behind it move up
+bool QueueTurn(Game* game, int direction, double time) {
+        if (game->gameOver || game->turnCount == TURN_QUEUE_SIZE) {
+                return false;
+        }
+        int facing = game->turnCount > 0 ? game->turnQueue[game->turnCount - 1] : game->snake.direction;
+        if (direction == facing || (direction == OppositeDirection(facing) && game->snake.length + game->snake.grow > 1)) {
+                return false;
+        }
+        game->turnQueue[game->turnCount] = direction;
+        game->turnTimes[game->turnCount] = time;
+        game->turnCount++;
+        return true;
+}
+
+// Function to take the first turn out of the queue, the turns wait until the snake may turn
+// The turn leaves the queue before TurnSnake checks it, so a turn into the border is lost rather than kept waiting
+// in front of the others: it could only be made after the snake turned along the border by itself
+int TakeQueuedTurn(Game* game, double* time) {
+        if (game->turnCount == 0 || !game->canMove) {
+                return ACTION_NONE;
+        }
+        int direction = game->turnQueue[0];
+        *time = game->turnTimes[0];
+        game->turnCount--;
+        for (int i = 0; i < game->turnCount; i++) {
+                game->turnQueue[i] = game->turnQueue[i + 1];
+                game->turnTimes[i] = game->turnTimes[i + 1];
+        }
+        return direction;
+}
+
+// Function to make one move of the game
+int StepGame(Game* game, int action) {
+        if (game->gameOver) {
+                return 0;
+        }
+        if (action != ACTION_NONE) {
+                TurnSnake(game, action);
+        }
+        int result = STEP_MOVED;
+        UpdateSnake(&game->snake);
+        game->moves++;
+        game->canMove = 1;
+        // Check if the snake has eaten the blue dot
+        if (checkDotCollision(&game->blueDot, &game->snake)) {
+                growSnake(&game->snake);
+                result |= STEP_ATE;
+                // If there is no free cell left for a new dot, the game is won
+                if (!InitDot(&game->blueDot, &game->snake, &game->rng)) {
+                        game->gameOver = 1;
+                        game->gameWon = 1;
+                        result |= STEP_WON;
+                }
+        }
+        // Check if the snake collided with itself
+        if (!game->gameWon && checkCollision(&game->snake)) {
+                game->gameOver = 1;
+                result |= STEP_DIED;
+        }
+        return result;
+}
+
+// Function to add real time that the game has to catch up with
+void AddGameTime(Game* game, double delta) {
+        game->clockTime += delta;
+        game->frameMoves = 0;
+}
+
+// Function to run the world time up to the next move
+// Moves and speedups are scheduled from the times of the previous ones, never from the frame times,
+// so the same game time always gives the same moves. Speedups before the move are applied on the way.
+bool TakeMove(Game* game) {
+        if (game->gameOver) {
+                return false;
+        }
+        // After too many moves for one frame the rest of the stall is dropped, so a slow frame cannot make the next one slower
+        if (game->frameMoves == MAX_CATCHUP_MOVES) {
+                game->clockTime = game->worldTime;
+                return false;
+        }
+        while (true) {
+                double moveTime = game->lastMoveTime + game->snake.speed;
+                // A speedup can make a move overdue, it then happens right away
+                if (moveTime < game->worldTime) {
+                        moveTime = game->worldTime;
+                }
+                if (game->nextSpeedupTime < moveTime) {
+                        if (game->nextSpeedupTime > game->clockTime) {
+                                break;
+                        }
+                        // If enough time has passed since the last speedup, the snake speeds up
+                        game->worldTime = game->nextSpeedupTime;
+                        SpeedUp(&game->snake);
+                        game->nextSpeedupTime += SPEEDUP_TIME;
+                        continue;
+                }
+                if (moveTime > game->clockTime) {
+                        break;
+                }
+                // If ennough time has passed since the last move, the snake moves
+                game->worldTime = moveTime;
+                game->lastMoveTime = moveTime;
+                game->frameMoves++;
+                return true;
+        }
+        game->worldTime = game->clockTime;
+        return false;
+}
+
+// Function to copy a whole game, the arrays of the snake are copied into the ones dst already has
+// Arrays of another size (a longer snake, another board) are allocated again first
+void CopyGame(Game* dst, Game* src) {
+        Snake snake = dst->snake;
+        if (snake.capacity != src->snake.capacity) {
+                delete[] snake.body;
+                snake.body = new int[src->snake.capacity];
+        }
+        if (snake.words != src->snake.words) {
+                delete[] snake.occupied;
+                snake.occupied = new uint64_t[BoardWords(&src->snake)];
+        }
+        memcpy(snake.body, src->snake.body, sizeof(int) * src->snake.capacity);
+        memcpy(snake.occupied, src->snake.occupied, sizeof(uint64_t) * BoardWords(&src->snake));
+        *dst = *src;
+        dst->snake.body = snake.body;
+        dst->snake.occupied = snake.occupied;
+        dst->snake.freeTree = (int*)(snake.occupied + src->snake.words);
+}
+
+// Function to free the memory of a game
+void FreeGame(Game* game) {
+        FreeSnake(&game->snake);
+}
+
+// ------------------
+// SNAPSHOT FUNCTIONS
+// ------------------
+
+// A snapshot keeps the fields of a game by value, so Game has to stay a plain struct
+static_assert(std::is_trivially_copyable<Game>::value, "Game has to be copyable by value");
+
+void InitGameSnapshot(GameSnapshot* snapshot) {
+        snapshot->capacity = SNAKE_CAPACITY;
+        snapshot->cells = new int[snapshot->capacity];
+        snapshot->board = NULL;
+        snapshot->boardCapacity = 0;
+        snapshot->savedBoard = 0;
+        memset(&snapshot->game, 0, sizeof(Game));
+}
+
+// Function to save the game, the cells of the snake are copied out of the ring buffer in at most two pieces
+void SaveGameSnapshot(GameSnapshot* snapshot, Game* game) {
+        Snake* snake = &game->snake;
+        if (snapshot->capacity < snake->length) {
+                while (snapshot->capacity < snake->length) {
+                        snapshot->capacity *= 2;
+                }
+                delete[] snapshot->cells;
+                snapshot->cells = new int[snapshot->capacity];
+        }
+        int first = snake->capacity - snake->tail;
+        if (first >= snake->length) {
+                memcpy(snapshot->cells, snake->body + snake->tail, sizeof(int) * snake->length);
+        }
+        else {
+                memcpy(snapshot->cells, snake->body + snake->tail, sizeof(int) * first);
+                memcpy(snapshot->cells + first, snake->body, sizeof(int) * (snake->length - first));
+        }
+        // A long snake on a small board is put back faster by copying the board than cell by cell
+        int words = BoardWords(snake);
+        snapshot->savedBoard = words <= 2 * snake->length;
+        if (snapshot->savedBoard) {
+                if (snapshot->boardCapacity < words) {
+                        delete[] snapshot->board;
+                        snapshot->boardCapacity = words;
+                        snapshot->board = new uint64_t[snapshot->boardCapacity];
+                }
+                memcpy(snapshot->board, snake->occupied, sizeof(uint64_t) * words);
+        }
+        snapshot->game = *game;
+}
+
+// Function to restore a saved game: the current snake leaves the board, the saved one is put on it cell by cell
+// (or the saved board is copied over) and the other fields are copied. The arrays stay the ones of the game
+void RestoreGameSnapshot(Game* game, GameSnapshot* snapshot) {
+        if (!snapshot->savedBoard) {
+                ClearSnakeCells(&game->snake);
+        }
+        Snake board = game->snake;
+        *game = snapshot->game;
+        Snake* snake = &game->snake;
+        snake->body = board.body;
+        snake->capacity = board.capacity;
+        snake->occupied = board.occupied;
+        snake->freeTree = board.freeTree;
+        snake->freeCount = board.freeCount;
+        if (snake->capacity < snake->length) {
+                while (snake->capacity < snake->length) {
+                        snake->capacity *= 2;
+                }
+                delete[] snake->body;
+                snake->body = new int[snake->capacity];
+        }
+        memcpy(snake->body, snapshot->cells, sizeof(int) * snake->length);
+        snake->tail = 0;
+        snake->head = snake->length - 1;
+        if (snapshot->savedBoard) {
+                memcpy(snake->occupied, snapshot->board, sizeof(uint64_t) * BoardWords(snake));
+                snake->freeCount = snapshot->game.snake.freeCount;
+                return;
+        }
+        // Like ClearSnakeCells, a snake longer than the bitset is put on the board first and the tree is counted again after it
+        if (snake->length < snake->words) {
+                ChangeCells(snake, snake->body, snake->length, true);
+        }
+        else {
+                for (int i = 0; i < snake->length; i++) {
+                        int cell = snake->body[i];
+                        if (cell >= 0) {
+                                snake->occupied[cell >> 6] |= (uint64_t)1 << (cell & 63);
+                        }
+                }
+                BuildFreeTree(snake);
+        }
+}
+
+void FreeGameSnapshot(GameSnapshot* snapshot) {
+        delete[] snapshot->cells;
+        delete[] snapshot->board;
+        snapshot->cells = NULL;
+        snapshot->board = NULL;
+}
+
+// --------------
+// UNDO FUNCTIONS
+// --------------
+
+void InitUndoLog(UndoLog* log, int capacity) {
+        log->capacity = capacity > 0 ? capacity : 1;
+        log->entries = new UndoEntry[log->capacity];
+        log->first = 0;
+        log->count = 0;
+}
+
+// Function to make a move and log the fields it changes, the cells it changes follow from the tail and the new head
+int StepGameLogged(Game* game, int action, UndoLog* log) {
+        if (game->gameOver) {
+                return 0;
+        }
+        Snake* snake = &game->snake;
+        // The oldest entry makes room for the new one when the log is full
+        if (log->count == log->capacity) {
+                log->first = (log->first + 1) % log->capacity;
+                log->count--;
+        }
+        UndoEntry* entry = &log->entries[(log->first + log->count) % log->capacity];
+        entry->rng = game->rng;
+        entry->blueDot = game->blueDot;
+        entry->headSegment = snake->headSegment;
+        entry->direction = snake->direction;
+        entry->grow = snake->grow;
+        entry->leftTail = snake->grow > 0 ? -1 : SnakeCell(snake, snake->length - 1);
+        entry->collided = snake->collided;
+        entry->canMove = game->canMove;
+        entry->gameOver = game->gameOver;
+        entry->gameWon = game->gameWon;
+        int result = StepGame(game, action);
+        entry->tookHead = SnakeCell(snake, 0) >= 0 && !snake->collided;
+        log->count++;
+        return result;
+}
+
+// Function to take back the last logged moves, newest first
+// The new head leaves the ring buffer before the old tail comes back: in a full ring the head took the slot of that tail.
+// A move that grew the ring buffer is taken back in the larger one, the order of the segments is the same
+int UndoMoves(Game* game, UndoLog* log, int moves) {
+        Snake* snake = &game->snake;
+        int undone = 0;
+        while (undone < moves && log->count > 0) {
+                log->count--;
+                UndoEntry* entry = &log->entries[(log->first + log->count) % log->capacity];
+                if (entry->tookHead) {
+                        ReleaseCell(snake, SnakeCell(snake, 0));
+                }
+                snake->head = snake->head == 0 ? snake->capacity - 1 : snake->head - 1;
+                snake->length--;
+                if (entry->leftTail >= 0) {
+                        snake->tail = snake->tail == 0 ? snake->capacity - 1 : snake->tail - 1;
+                        snake->body[snake->tail] = entry->leftTail;
+                        OccupyCell(snake, entry->leftTail);
+                        snake->length++;
+                }
+                snake->headSegment = entry->headSegment;
+                snake->direction = entry->direction;
+                snake->grow = entry->grow;
+                snake->collided = entry->collided;
+                game->rng = entry->rng;
+                game->blueDot = entry->blueDot;
+                game->canMove = entry->canMove;
+                game->gameOver = entry->gameOver;
+                game->gameWon = entry->gameWon;
+                game->moves--;
+                undone++;
+        }
+        return undone;
+}
+
+void ClearUndoLog(UndoLog* log) {
+        log->first = 0;
+        log->count = 0;
+}
+
+void FreeUndoLog(UndoLog* log) {
+        delete[] log->entries;
+        log->entries = NULL;
+}
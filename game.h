@@ -0,0 +1,271 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// game: the rules of the game, without SDL, so they can also run headless
+
+#ifndef GAME_H
+#define GAME_H
+
+#include<stddef.h>
+#include<stdint.h>
+
+// ------------------
+// DEFINING CONSTANTS
+// ------------------
+
+#define ROW_CELLS       32 // The number of cells in a row of the default board
+#define COL_CELLS       20 // The number of cells in a column of the default board
+
+#define MIN_BOARD_SIZE 2 // The smallest width and height of a board
+#define MAX_BOARD_CELLS (1 << 30) // The most cells of a board, a cell index has to fit in an int
+#define FREE_BLOCK_WORDS 8 // Words of the occupancy bitset counted together by one entry of the free cell tree
+#define FREE_BLOCK_CELLS (FREE_BLOCK_WORDS * 64)
+
+// The direction numbers
+#define RIGHT 0
+#define LEFT 1
+#define UP 2
+#define DOWN 3
+
+#define ACTION_NONE -1 // StepGame action that keeps the current direction
+
+// Flags returned by StepGame
+#define STEP_MOVED 1 // the snake moved by one cell
+#define STEP_ATE 2 // the snake ate the dot and a new dot was placed
+#define STEP_DIED 4 // the snake collided with itself or left the board
+#define STEP_WON 8 // the snake fills the whole board
+
+#define SNAKE_LENGTH 1; // The initial length of the snake
+#define SNAKE_CAPACITY 64 // The first size of the ring buffer of the body, it doubles whenever the snake outgrows it
+
+#define SPEEDUP 0.8; // How much a snake shoudl speedup after a certain time (1-SPEEDUP)% of the current speed
+const int SPEEDUP_TIME = 5; // The time innterval after which the snake speeds up (whole seconds)
+
+#define MAX_CATCHUP_MOVES 32 // The most moves made for one AddGameTime, the rest of a longer stall is dropped
+#define TURN_QUEUE_SIZE 3 // The most turns waiting for the next moves, further key presses are dropped
+
+// -------------------
+// DEFINING STRUCTURES
+// -------------------
+
+// Random number generator owned by a game (xoshiro256**), the same seed always gives the same numbers
+struct Random {
+        uint64_t state[4];
+};
+
+struct Segment {
+        int x;
+        int y;
+};
+
+struct Snake {
+        int* body; // ring buffer with the cell index of every segment, -1 for a head that left the board
+        int capacity; // number of slots in the ring buffer
+        int head; // index of the head segment in the ring buffer
+        int tail; // index of the last segment in the ring buffer
+        int length; // length of the snake
+        Segment headSegment; // the head as x, y, so a move needs no division (off the board when the snake left it)
+        int grow; // number of segments still to be added at the tail
+        int width; // the size of the board in cells
+        int height;
+        // occupied and freeTree are one allocation made for the board, a new game on the same board only clears it
+        uint64_t* occupied; // one bit for every cell of the board taken by the snake, the bits after the last cell are set
+        int words; // number of 64 bit words in occupied
+        int blocks; // number of blocks of FREE_BLOCK_WORDS words
+        int* freeTree; // Fenwick tree of the free cells in every block of occupied (1-based), finds a free cell by its rank
+        int freeCount; // number of cells not taken by the snake
+        int collided; // the head moved into a cell the snake already takes
+        int direction; // direction of the snake
+        double speed; // speed of the snake
+};
+
+struct Dot {
+        int x;
+        int y;
+};
+
+// The whole state of a single game
+struct Game {
+        Snake snake;
+        Dot blueDot;
+        Random rng; // draws the positions of the dots
+        uint64_t seed; // the seed the game was started with
+        int moves; // moves made since the start of the game
+        double worldTime; // time since the start of the game (seconds), simulated so far
+        double clockTime; // all the time added with AddGameTime, worldTime catches up with it
+        double lastMoveTime; // world time of the last move of the snake
+        double nextSpeedupTime; // world time of the next speedup
+        int frameMoves; // moves taken since the last AddGameTime
+        int canMove; // the snake moved since the last turn, so it may turn again
+        int turnQueue[TURN_QUEUE_SIZE]; // turns given for the next moves, one is made on every move
+        double turnTimes[TURN_QUEUE_SIZE]; // the time each queued turn was given, in the caller's clock
+        int turnCount;
+        int gameOver;
+        int gameWon;
+};
+
+// A saved position of a game for lookahead search: the fields of the game and the cells of the snake
+// The board is rebuilt from the cells on restore, so saving and restoring take time of the snake length, not of the board size.
+// Only when the board takes at most two words for every cell of the snake, it is saved too and copied back as it is
+struct GameSnapshot {
+        Game game; // a copy of the fields of the game, its pointers belong to the game it was saved from
+        int* cells; // the cells of the snake from the tail to the head
+        int capacity; // slots in cells, it doubles when a longer snake is saved
+        uint64_t* board; // the bitset and the tree of the board, when savedBoard is set
+        int boardCapacity; // words in board
+        int savedBoard;
+};
+
+// How to take back one StepGame: the fields it changed and the cells it took or gave back
+struct UndoEntry {
+        Random rng; // the generator before the move, eating a dot draws from it
+        Dot blueDot;
+        Segment headSegment; // the head before the move
+        int direction;
+        int grow;
+        int leftTail; // the cell the tail left, -1 when the snake grew instead
+        int tookHead; // the head took a free cell (not when it left the board or ran into the body)
+        int collided;
+        int canMove;
+        int gameOver;
+        int gameWon;
+};
+
+// The last moves of a game with the entries to take them back, a ring buffer that forgets the oldest ones when full
+struct UndoLog {
+        UndoEntry* entries;
+        int capacity;
+        int first; // the oldest entry
+        int count;
+};
+
+// ----------------
+// RANDOM FUNCTIONS
+// ----------------
+
+void SeedRandom(Random* rng, uint64_t seed);
+uint64_t NextRandom(Random* rng);
+uint32_t RandomBelow(Random* rng, uint32_t n);
+
+// ---------------
+// BOARD FUNCTIONS
+// ---------------
+
+// the i-th segment of the snake (0 is the head), any segment but the head is found with a division
+Segment SnakeSegment(Snake* snake, int i);
+int SnakeCell(Snake* snake, int i);
+int CellIndex(int width, int x, int y);
+bool InsideBoard(int width, int height, int x, int y);
+bool BoardSizeAllowed(int width, int height);
+bool CellBit(const uint64_t* bits, int cell);
+bool CellOccupied(Snake* snake, int x, int y);
+
+// the cell of the rank-th free cell of an occupancy bitset, counted in the order of the cells
+// scans the words one by one, so it is meant for small boards
+int SelectFreeCell(const uint64_t* occupied, int words, int rank);
+
+// ---------------
+// SNAKE FUNCTIONS
+// ---------------
+
+void InitSnake(Snake* snake, int width, int height);
+
+// put the snake back at the start of its board in the memory it already has
+void ResetSnake(Snake* snake);
+bool canTurn(Snake* snake, int x, int y, int direction);
+bool GridCanTurn(const uint64_t* occupied, int width, int height, int x, int y, int direction);
+void MoveHead(const uint64_t* occupied, int width, int height, Segment* head, int* direction);
+void growSnake(Snake* snake);
+void SpeedUp(Snake* snake);
+void UpdateSnake(Snake* snake);
+bool checkCollision(Snake* snake);
+void FreeSnake(Snake* snake);
+
+// -------------
+// DOT FUNCTIONS
+// -------------
+
+bool InitDot(Dot* blueDot, Snake* snake, Random* rng);
+bool checkDotCollision(Dot* blueDot, Snake* snake);
+
+// --------------
+// GAME FUNCTIONS
+// --------------
+
+// start a new game, the previous one has to be freed with FreeGame first
+// games started with the same seed and given the same turns at the same moves play out the same way
+void InitGame(Game* game, uint64_t seed);
+
+// start a new game on a board of width x height cells, the size has to pass BoardSizeAllowed
+void InitGameOfSize(Game* game, uint64_t seed, int width, int height);
+
+// start a new game on the board of an initialized game without allocating, it plays out the same way as InitGameOfSize
+// the body keeps the capacity the last snake grew it to
+void ResetGame(Game* game, uint64_t seed);
+
+// the bytes of memory the game takes, the Game itself and its arrays
+size_t GameMemory(Game* game);
+
+// copy the whole state of src into dst, dst has to be an initialized game, its arrays are resized when they differ
+void CopyGame(Game* dst, Game* src);
+
+// turn the snake the way the arrow keys do, returns false when the turn is not allowed now
+bool TurnSnake(Game* game, int direction);
+// length is the length of the snake with the segments it still grows by
+bool TurnAllowed(Segment* head, int length, int direction, int newDirection, int width, int height);
+
+// queue a turn for one of the next moves, time is kept for the caller to measure the latency
+// returns false when the queue is full or the snake will already face that way or its opposite after the queued turns
+bool QueueTurn(Game* game, int direction, double time);
+
+// take the turn for the coming move out of the queue (ACTION_NONE when there is none or the snake cannot turn yet)
+// time is set to the time the turn was queued with, a turn TurnSnake then rejects at the border is dropped
+int TakeQueuedTurn(Game* game, double* time);
+
+// one move of the snake: turn (unless action is ACTION_NONE), move, eat the dot and check collisions
+// returns the STEP_ flags describing what happened
+int StepGame(Game* game, int action);
+
+// add delta seconds of real time to be simulated by TakeMove
+void AddGameTime(Game* game, double delta);
+
+// let the added time pass up to the next move and return true when that move is due, the caller then calls StepGame
+// moves and speedups happen at fixed points of game time, no matter how the time was split between calls
+bool TakeMove(Game* game);
+
+// free the memory of a game
+void FreeGame(Game* game);
+
+// ------------------
+// SNAPSHOT FUNCTIONS
+// ------------------
+
+void InitGameSnapshot(GameSnapshot* snapshot);
+
+// save the position of the game, in time of the snake length (or of the board, when it is smaller)
+void SaveGameSnapshot(GameSnapshot* snapshot, Game* game);
+
+// bring the game back to a position saved from a game on a board of the same size
+// takes time of the length of both snakes, the body is only allocated again when the saved snake does not fit
+void RestoreGameSnapshot(Game* game, GameSnapshot* snapshot);
+
+void FreeGameSnapshot(GameSnapshot* snapshot);
+
+// --------------
+// UNDO FUNCTIONS
+// --------------
+
+// keep the last capacity moves of a game
+void InitUndoLog(UndoLog* log, int capacity);
+
+// StepGame that also logs how to take the move back, a move of a finished game changes nothing and is not logged
+int StepGameLogged(Game* game, int action, UndoLog* log);
+
+// take back the last moves logged (at most the ones still in the log) in the order they were made, returns how many
+// the game is then the same as before them, bit for bit on the board, without copying it
+int UndoMoves(Game* game, UndoLog* log, int moves);
+
+// forget the logged moves, needed when the game was changed another way (RestoreGameSnapshot, ResetGame, CopyGame)
+void ClearUndoLog(UndoLog* log);
+void FreeUndoLog(UndoLog* log);
+
+#endif
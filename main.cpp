@@ -11,360 +11,509 @@
 #include<string.h>
 #include<stdlib.h>
 #include<math.h>
+#include<chrono>
 
 extern "C" {
 #include"./SDL2-2.0.10/include/SDL.h"
 #include"./SDL2-2.0.10/include/SDL_main.h"
 }
 
+#include"game.h"
+#include"draw.h"
+#include"assets.h"
+#include"replay.h"
+#include"autopilot.h"
+#include"profile.h"
+#include"video.h"
+
 // ------------------
 // DEFINING CONSTANTS
 // ------------------
 
-#define SCREEN_WIDTH 640 // pixels
-#define SCREEN_HEIGHT 440 // pixels
-
-#define INFO_AREA_HEIGHT (SCREEN_HEIGHT / 11) // The height of the area where all the information is displayed
-#define GAME_BOARD_HEIGHT (SCREEN_HEIGHT - INFO_AREA_HEIGHT) // The height of the game board
+#define MAX_DIRTY_RECTS 64 // How many damaged rectangles can be collected before the whole screen is redrawn
+#define HUD_DIRTY_RECTS 2 // Rectangles the info time and the profiler overlay may add after the cells are repainted
 
-#define CELL_SIZE       20 // The size of a single cell in the game board
-#define ROW_CELLS       (SCREEN_WIDTH / CELL_SIZE) // The number of cells in a row
-#define COL_CELLS       (GAME_BOARD_HEIGHT / CELL_SIZE) // The number of cells in a column
+// The lines of text kept in the TextCache
+#define TEXT_INFO_TIME 0
+#define TEXT_INFO_KEYS 1
+#define TEXT_MESSAGE 2 // Game Over, You Won or Paused
+#define TEXT_MESSAGE_KEYS 3
+#define TEXT_PROFILE 4 // The header and one line for every phase of the profiler overlay
+#define INFO_TIME_Y 10 // The y coordinate of the info line showing the time
 
-// The direction numbers
-#define RIGHT 0
-#define LEFT 1
-#define UP 2
-#define DOWN 3
+#define DEFAULT_FPS 60 // The frame rate the main loop is limited to, unless --fps or --vsync is given
+#define IDLE_WAIT_MS 250 // How long the main loop waits for an event when nothing on the screen changes
 
-#define SNAKE_LENGTH 1; // The initial length of the snake
+#define EXPORT_FPS 30 // The frame rate of a video made with --export, unless --export-fps is given
+#define EXPORT_SECONDS 60 // The most seconds of the game put into a video, unless --export-seconds is given
+#define EXPORT_END_FRAMES 60 // Frames showing the end of the game at the end of a video
 
-#define SPEEDUP 0.8; // How much a snake shoudl speedup after a certain time (1-SPEEDUP)% of the current speed
-const int SPEEDUP_TIME = 5; // The time innterval after which the snake speeds up (whole seconds)
+#define OVERLAY_X 4 // The top left corner of the profiler overlay (built with -DSNAKE_PROFILER), over the game board
+#define OVERLAY_Y (INFO_AREA_HEIGHT + 4)
 
 // -------------------
 // DEFINING STRUCTURES
 // -------------------
 
-struct Segment {
-        int x;
-        int y;
+// The time from a key press to the move that turned the snake, for the turns of the current measurement period
+struct InputLatency {
+        double totalMs;
+        double maxMs;
+        int samples;
 };
 
-struct Snake {
-        Segment* body; // creating an array of the whole snake body
-        int length; // length of the snake
-        int direction; // direction of the snake
-        double speed; // speed of the snake
+struct FramePacer {
+        Uint64 frequency; // performance counter ticks per second
+        Uint64 period; // counter ticks per frame, 0 when the frame rate is not limited by sleeping
+        Uint64 deadline; // counter value at which the next frame may start
+        Uint64 frameStart; // counter value at which the current frame started
+        Uint64 statsStart; // start of the current measurement period
+        Uint64 busyTicks; // time spent working on frames (not sleeping) in the measurement period
+        int frames; // frames in the measurement period
+        double fps; // achieved frame rate of the last measurement period
+        double busyMs; // average wall-clock time spent working on one frame in the last measurement period, without the waits
 };
 
-struct Dot {
-        int x;
-        int y;
+struct DirtyRects {
+        SDL_Rect rects[MAX_DIRTY_RECTS]; // parts of the screen that changed since the last frame
+        int count; // number of collected rectangles
+        int full; // the whole screen has to be redrawn
 };
 
-// --------------
-// DRAW FUNCTIONS
-// --------------
+// -------------------------
+// DIRTY RECTANGLE FUNCTIONS
+// -------------------------
 
-// draw a text txt on surface screen, starting from the point (x, y)
-// charset is a 128x128 bitmap containing character images
-void DrawString(SDL_Surface* screen, int x, int y, const char* text, SDL_Surface* charset) {
-        int px, py, c;
-        SDL_Rect s, d;
-        s.w = 8;
-        s.h = 8;
-        d.w = 8;
-        d.h = 8;
-        while (*text) {
-                c = *text & 255;
-                px = (c % 16) * 8;
-                py = (c / 16) * 8;
-                s.x = px;
-                s.y = py;
-                d.x = x;
-                d.y = y;
-                SDL_BlitSurface(charset, &s, screen, &d);
-                x += 8;
-                text++;
+// Function to mark a part of the screen as changed, too many rectangles fall back to a full redraw
+void MarkDirty(DirtyRects* dirty, int x, int y, int w, int h) {
+        if (dirty->full) {
+                return;
         }
+        if (dirty->count == MAX_DIRTY_RECTS) {
+                dirty->full = 1;
+                return;
+        }
+        SDL_Rect* rect = &dirty->rects[dirty->count++];
+        rect->x = x;
+        rect->y = y;
+        rect->w = w;
+        rect->h = h;
 }
 
-// draw a surface sprite on a surface screen in point (x, y)
-// (x, y) is the center of sprite on screen
-void DrawSurface(SDL_Surface* screen, SDL_Surface* sprite, int x, int y) {
-        SDL_Rect dest;
-        dest.x = x - sprite->w / 2;
-        dest.y = y - sprite->h / 2;
-        dest.w = sprite->w;
-        dest.h = sprite->h;
-        SDL_BlitSurface(sprite, NULL, screen, &dest);
+// Function to mark a single cell of the game board as changed, cells outside the view are ignored
+void MarkCellDirty(DirtyRects* dirty, Camera* camera, int x, int y) {
+        if (CellVisible(camera, x, y)) {
+                MarkDirty(dirty, CellScreenX(camera, x), CellScreenY(camera, y), CELL_SIZE, CELL_SIZE);
+        }
 }
 
-// draw a single pixel
-void DrawPixel(SDL_Surface* surface, int x, int y, Uint32 color) {
-        int bpp = surface->format->BytesPerPixel;
-        Uint8* p = (Uint8*)surface->pixels + y * surface->pitch + x * bpp;
-        *(Uint32*)p = color;
+// Function to forget all the collected rectangles after they were presented
+void ClearDirty(DirtyRects* dirty) {
+        dirty->count = 0;
+        dirty->full = 0;
 }
 
-// draw a vertical (when dx = 0, dy = 1) or horizontal (when dx = 1, dy = 0) line
-void DrawLine(SDL_Surface* screen, int x, int y, int l, int dx, int dy, Uint32 color) {
-        for (int i = 0; i < l; i++) {
-                DrawPixel(screen, x, y, color);
-                x += dx;
-                y += dy;
+// Function to repaint a single visible cell of the game board: background, grid, snake and dot
+// The background and the grid of the cell are copied from the cached static layer
+void RedrawCell(SDL_Surface* screen, BackgroundCache* background, Camera* camera, Snake* snake, Dot* blueDot, SDL_Surface* dotSurface, int drawDot, int x, int y,
+        Uint32 headColor, Uint32 bodyColor, Uint32 borderColor) {
+        SDL_Rect cell;
+        cell.x = CellScreenX(camera, x);
+        cell.y = CellScreenY(camera, y);
+        cell.w = CELL_SIZE;
+        cell.h = CELL_SIZE;
+        RestoreBackground(screen, background, &cell);
+        Segment head = SnakeSegment(snake, 0);
+        if (head.x == x && head.y == y) {
+                DrawRectangle(screen, cell.x, cell.y, CELL_SIZE, CELL_SIZE, borderColor, headColor);
         }
-}
-
-// draw a rectangle of size l by k
-void DrawRectangle(SDL_Surface* screen, int x, int y, int l, int k, Uint32 outlineColor, Uint32 fillColor) {
-        int i;
-        DrawLine(screen, x, y, k, 0, 1, outlineColor);
-        DrawLine(screen, x + l - 1, y, k, 0, 1, outlineColor);
-        DrawLine(screen, x, y, l, 1, 0, outlineColor);
-        DrawLine(screen, x, y + k - 1, l, 1, 0, outlineColor);
-        for (i = y + 1; i < y + k - 1; i++) {
-                DrawLine(screen, x + 1, i, l - 2, 1, 0, fillColor);
+        else if (CellOccupied(snake, x, y)) {
+                DrawRectangle(screen, cell.x, cell.y, CELL_SIZE, CELL_SIZE, borderColor, bodyColor);
+        }
+        if (drawDot && blueDot->x == x && blueDot->y == y) {
+                DrawDot(screen, dotSurface, blueDot, camera);
         }
 }
 
-// Function to draw the dot on the game board
-void DrawDot(SDL_Surface* screen, SDL_Surface* dotSurface, Dot* blueDot) {
-        int x = blueDot->x * CELL_SIZE;
-        int y = INFO_AREA_HEIGHT + blueDot->y * CELL_SIZE;
-        SDL_Rect dest;
-        dest.x = x;
-        dest.y = y;
-        dest.w = CELL_SIZE;
-        dest.h = CELL_SIZE;
-        SDL_BlitScaled(dotSurface, NULL, screen, &dest);
+// Function to copy only the changed rectangles of the screen surface into the texture
+void UploadDirty(SDL_Texture* texture, SDL_Surface* screen, DirtyRects* dirty) {
+        if (dirty->full) {
+                SDL_UpdateTexture(texture, NULL, screen->pixels, screen->pitch);
+                return;
+        }
+        for (int i = 0; i < dirty->count; i++) {
+                SDL_Rect* rect = &dirty->rects[i];
+                Uint8* pixels = (Uint8*)screen->pixels + rect->y * screen->pitch + rect->x * screen->format->BytesPerPixel;
+                SDL_UpdateTexture(texture, rect, pixels, screen->pitch);
+        }
 }
 
-// Function to draw the grey grid on the game board
-void DrawGrid(SDL_Surface* screen, Uint32 gridColor) {
-        // vertical lines
-        for (int x = 0; x <= SCREEN_WIDTH; x += CELL_SIZE) {
-                DrawLine(screen, x, INFO_AREA_HEIGHT, GAME_BOARD_HEIGHT, 0, 1, gridColor);
+// Function to lock the whole texture and get a surface that draws straight into its pixels
+// The locked pixels are undefined, so the whole frame has to be drawn. Returns NULL when the texture cannot be locked
+SDL_Surface* LockFrame(SDL_Texture* texture) {
+        void* pixels;
+        int pitch;
+        if (SDL_LockTexture(texture, NULL, &pixels, &pitch) != 0) {
+                return NULL;
         }
-        // horizontal lines
-        for (int y = INFO_AREA_HEIGHT; y <= SCREEN_HEIGHT; y += CELL_SIZE) {
-                DrawLine(screen, 0, y, SCREEN_WIDTH, 1, 0, gridColor);
+        SDL_Surface* frame = SDL_CreateRGBSurfaceFrom(pixels, SCREEN_WIDTH, SCREEN_HEIGHT, 32, pitch, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+        if (frame == NULL) {
+                SDL_UnlockTexture(texture);
         }
+        return frame;
 }
 
-// ---------------
-// SNAKE FUNCTIONS
-// ---------------
+// Function to give the pixels drawn through LockFrame back to the texture
+void UnlockFrame(SDL_Texture* texture, SDL_Surface* frame) {
+        SDL_FreeSurface(frame);
+        SDL_UnlockTexture(texture);
+}
 
-// Function to Initialize the snake
-void InitSnake(Snake* snake) {
-        snake->body = new Segment[ROW_CELLS * COL_CELLS];
-        snake->length = SNAKE_LENGTH;
-        for (int i = 0; i < snake->length; i++) {
-                snake->body[i].x = ROW_CELLS / 2 - i;
-                snake->body[i].y = COL_CELLS / 2;
-        }
-        snake->direction = RIGHT;
-        snake->speed = 0.2; // move every x seconds
+// ----------------------
+// FRAME PACING FUNCTIONS
+// ----------------------
+
+// Function to initialize the frame pacer, targetFps 0 means the frame rate is not limited by sleeping
+void InitFramePacer(FramePacer* pacer, int targetFps) {
+        pacer->frequency = SDL_GetPerformanceFrequency();
+        pacer->period = targetFps > 0 ? pacer->frequency / targetFps : 0;
+        pacer->deadline = SDL_GetPerformanceCounter();
+        pacer->frameStart = pacer->deadline;
+        pacer->statsStart = pacer->deadline;
+        pacer->busyTicks = 0;
+        pacer->frames = 0;
+        pacer->fps = 0;
+        pacer->busyMs = 0;
 }
 
-// Function to check if the snake can turn at the border
-bool canTurn(Snake* snake, int direction) {
-        if (direction == DOWN) {
-                for (int i = 1; i < snake->length; i++) {
-                        if (snake->body[0].x == snake->body[i].x && snake->body[0].y + 1 == snake->body[i].y) {
-                                return false;
-                        }
+// Function to mark the start of the work on a frame
+void BeginFrame(FramePacer* pacer) {
+        pacer->frameStart = SDL_GetPerformanceCounter();
+}
+
+// Function to sleep until the performance counter reaches the deadline
+// SDL_Delay sleeps whole milliseconds, so the frame may start up to a millisecond late, but never early
+void SleepUntil(FramePacer* pacer, Uint64 deadline) {
+        while (true) {
+                Uint64 now = SDL_GetPerformanceCounter();
+                if (now >= deadline) {
+                        return;
                 }
-                return true;
+                Uint32 ms = (Uint32)((deadline - now) * 1000 / pacer->frequency);
+                SDL_Delay(ms > 0 ? ms : 1);
         }
-        else if (direction == UP) {
-                for (int i = 1; i < snake->length; i++) {
-                        if (snake->body[0].x == snake->body[i].x && snake->body[0].y - 1 == snake->body[i].y) {
-                                return false;
-                        }
-                }
-                return true;
+}
+
+// Function to end a frame: when idle, wait for the next event instead of drawing frames nobody needs,
+// otherwise sleep until the next frame is due. Returns true when new statistics were measured (once a second)
+bool EndFrame(FramePacer* pacer, int idle) {
+        Uint64 now = SDL_GetPerformanceCounter();
+        pacer->busyTicks += now - pacer->frameStart;
+        pacer->frames++;
+        if (idle) {
+                // The event stays in the queue, it is handled by the next frame
+                SDL_WaitEventTimeout(NULL, IDLE_WAIT_MS);
+                pacer->deadline = SDL_GetPerformanceCounter();
         }
-        else if (direction == RIGHT) {
-                for (int i = 1; i < snake->length; i++) {
-                        if (snake->body[0].x + 1 == snake->body[i].x && snake->body[0].y == snake->body[i].y) {
-                                return false;
-                        }
+        else if (pacer->period > 0) {
+                pacer->deadline += pacer->period;
+                // A frame that was too late does not make the following frames come faster
+                if (pacer->deadline < now) {
+                        pacer->deadline = now;
                 }
-                return true;
+                SleepUntil(pacer, pacer->deadline);
         }
-        else if (direction == LEFT) {
-                for (int i = 1; i < snake->length; i++) {
-                        if (snake->body[0].x - 1 == snake->body[i].x && snake->body[0].y == snake->body[i].y) {
-                                return false;
-                        }
-                }
-                return true;
+        now = SDL_GetPerformanceCounter();
+        if (now - pacer->statsStart < pacer->frequency) {
+                return false;
         }
-        return false;
+        double seconds = (double)(now - pacer->statsStart) / pacer->frequency;
+        pacer->fps = pacer->frames / seconds;
+        pacer->busyMs = (double)pacer->busyTicks * 1000 / pacer->frequency / pacer->frames;
+        pacer->statsStart = now;
+        pacer->busyTicks = 0;
+        pacer->frames = 0;
+        return true;
 }
 
-// Function to add a segment to the snake when it eats the blue dot
-void growSnake(Snake* snake) {
-        snake->body[snake->length] = snake->body[snake->length - 1];
-        snake->length++;
+// --------------
+// GAME FUNCTIONS
+// --------------
+
+// Function the GameOver message
+void DisplayGameOver(SDL_Surface* screen, TextCache* cache, int gameWon) {
+        if (gameWon) {
+                SetTextLine(cache, TEXT_MESSAGE, "You Won! The snake fills the whole board!");
+        }
+        else {
+                SetTextLine(cache, TEXT_MESSAGE, "Game Over!");
+        }
+        DrawTextLineCentered(screen, cache, TEXT_MESSAGE, 45);
+
+        SetTextLine(cache, TEXT_MESSAGE_KEYS, "Press 'n' for a new game or 'Esc' to exit");
+        DrawTextLineCentered(screen, cache, TEXT_MESSAGE_KEYS, 60);
 }
 
-// Function to speed up the snake after a certain time
-void SpeedUp(Snake* snake) {
-        snake->speed *= SPEEDUP;
+// Function the Paused message
+void DisplayPaused(SDL_Surface* screen, TextCache* cache) {
+        SetTextLine(cache, TEXT_MESSAGE, "Paused - press 'p' to continue");
+        DrawTextLineCentered(screen, cache, TEXT_MESSAGE, 45);
 }
 
-// Function to update the position of the snake
-void UpdateSnake(Snake* snake) {
-        for (int i = snake->length - 1; i > 0; i--) {
-                snake->body[i].x = snake->body[i - 1].x;
-                snake->body[i].y = snake->body[i - 1].y;
-        }
-        if (snake->direction == RIGHT) {
-                if (snake->body[0].x == ROW_CELLS - 1) {
-                        if (snake->body[0].y < COL_CELLS - 1 && canTurn(snake, DOWN)) {
-                                snake->direction = DOWN;
-                                snake->body[0].y++;
-                        }
-                        else {
-                                snake->direction = UP;
-                                snake->body[0].y--;
-                        }
-                }
-                else {
-                        snake->body[0].x++;
-                }
+// Function to format the info line that shows the time, given in tenths of a second
+void FormatInfoTime(char* text, long long tenths) {
+        sprintf(text, "Jan Rudnicki 203179 - Snake, Time = %lld.%lld s, Implemented Requirements: 1-4,A,B", tenths / 10, tenths % 10);
+}
+
+// Function to bring the cached time line up to date, it is formatted and rasterized again only when the shown time changes
+// Returns true when the line has changed
+bool PrepareInfoTime(TextCache* cache, double worldTime) {
+        long long tenths = (long long)(worldTime * 10);
+        if (!TextLineOutdated(cache, TEXT_INFO_TIME, tenths)) {
+                return false;
         }
-        else if (snake->direction == LEFT) {
-                if (snake->body[0].x == 0) {
-                        if (snake->body[0].y > 0 && canTurn(snake, UP)) {
-                                snake->direction = UP;
-                                snake->body[0].y--;
-                        }
-                        else {
-                                snake->direction = DOWN;
-                                snake->body[0].y++;
-                        }
-                }
-                else {
-                        snake->body[0].x--;
-                }
+        char text[TEXT_LENGTH];
+        FormatInfoTime(text, tenths);
+        SetTextLine(cache, TEXT_INFO_TIME, text);
+        return true;
+}
+
+// Function to display the game information
+void DisplayInfoText(SDL_Surface* screen, TextCache* cache, double worldTime) {
+        PrepareInfoTime(cache, worldTime);
+        DrawTextLineCentered(screen, cache, TEXT_INFO_TIME, INFO_TIME_Y);
+        SetTextLine(cache, TEXT_INFO_KEYS, "Esc - exit, n - new game, p - pause, Move the snake using arrow keys");
+        DrawTextLineCentered(screen, cache, TEXT_INFO_KEYS, 26);
+}
+
+// Function to repaint the time line of the info area, but only when the shown time has changed
+void UpdateInfoTime(SDL_Surface* screen, TextCache* cache, BackgroundCache* background, double worldTime, DirtyRects* dirty) {
+        if (!PrepareInfoTime(cache, worldTime)) {
+                return;
         }
-        else if (snake->direction == UP) {
-                if (snake->body[0].y == 0) {
-                        if (snake->body[0].x < ROW_CELLS - 1 && canTurn(snake, RIGHT)) {
-                                snake->direction = RIGHT;
-                                snake->body[0].x++;
-                        }
-                        else {
-                                snake->direction = LEFT;
-                                snake->body[0].x--;
-                        }
-                }
-                else {
-                        snake->body[0].y--;
+        SDL_Rect line;
+        line.x = 1;
+        line.y = INFO_TIME_Y;
+        line.w = SCREEN_WIDTH - 2;
+        line.h = 8;
+        RestoreBackground(screen, background, &line);
+        DrawTextLineCentered(screen, cache, TEXT_INFO_TIME, INFO_TIME_Y);
+        MarkDirty(dirty, line.x, line.y, line.w, line.h);
+}
+
+// Function to make one move of the game and mark the cells it changed
+// The old head becomes body, the old tail cell may be left empty and an eaten dot moves somewhere else
+// When the camera has to follow the head, the whole view is drawn again
+int StepGameDirty(Game* game, Camera* camera, DirtyRects* dirty) {
+        Segment oldHead = SnakeSegment(&game->snake, 0);
+        Segment oldTail = SnakeSegment(&game->snake, game->snake.length - 1);
+        Dot oldDot = game->blueDot;
+        int result = StepGame(game, ACTION_NONE);
+        if (result & STEP_MOVED) {
+                MarkCellDirty(dirty, camera, oldHead.x, oldHead.y);
+                MarkCellDirty(dirty, camera, oldTail.x, oldTail.y);
+                Segment head = SnakeSegment(&game->snake, 0);
+                MarkCellDirty(dirty, camera, head.x, head.y);
+                if (FollowHead(camera, &head)) {
+                        dirty->full = 1;
                 }
         }
-        else if (snake->direction == DOWN) {
-                if (snake->body[0].y == COL_CELLS - 1) {
-                        if (snake->body[0].x > 0 && canTurn(snake, LEFT)) {
-                                snake->direction = LEFT;
-                                snake->body[0].x--;
-                        }
-                        else {
-                                snake->direction = RIGHT;
-                                snake->body[0].x++;
-                        }
-                }
-                else {
-                        snake->body[0].y++;
-                }
+        if (result & STEP_ATE) {
+                MarkCellDirty(dirty, camera, oldDot.x, oldDot.y);
+                MarkCellDirty(dirty, camera, game->blueDot.x, game->blueDot.y);
+        }
+        // The game over message needs a full redraw
+        if (result & (STEP_DIED | STEP_WON)) {
+                dirty->full = 1;
         }
+        return result;
 }
 
-// Function to Draw the snake
-void DrawSnake(SDL_Surface* screen, Snake* snake, Uint32 headColor, Uint32 bodyColor, Uint32 borderColor) {
-        for (int i = snake->length - 1; i >= 0; i--) {
-                int x = snake->body[i].x * CELL_SIZE;
-                int y = INFO_AREA_HEIGHT + snake->body[i].y * CELL_SIZE;
-                if (i == 0) {
-                        // Draw the head of the snake (headColor)
-                        DrawRectangle(screen, x, y, CELL_SIZE, CELL_SIZE, borderColor, headColor);
-                }
-                else {
-                        // Draw the rest of the snake (bodyColor)
-                        DrawRectangle(screen, x, y, CELL_SIZE, CELL_SIZE, borderColor, bodyColor);
-                }
+#ifdef SNAKE_PROFILER
+// Function to put the statistics of the frame phases into the text cache, after new ones were measured
+void PrepareProfileText(TextCache* cache, Profiler* profiler) {
+        char text[TEXT_LENGTH];
+        SetTextLine(cache, TEXT_PROFILE, "phase [ms]     min     avg     p99");
+        for (int i = 0; i < PHASE_COUNT; i++) {
+                PhaseStats* stats = &profiler->stats[i];
+                sprintf(text, "%-10s %7.3f %7.3f %7.3f", PHASE_NAMES[i], stats->minMs, stats->avgMs, stats->p99Ms);
+                SetTextLine(cache, TEXT_PROFILE + 1 + i, text);
         }
 }
 
-// Function to check if the snake has collided with itself
-bool checkCollision(Snake* snake) {
-        for (int i = 2; i < snake->length; i++) {
-                if (snake->body[0].x == snake->body[i].x && snake->body[0].y == snake->body[i].y) {
-                        return true;
-                }
+// Function to draw the statistics of the frame phases in a box over the game board and mark the box as changed
+void DisplayProfile(SDL_Surface* screen, TextCache* cache, Uint32 boxColor, DirtyRects* dirty) {
+        int w = 34 * 8 + 8;
+        int h = (PHASE_COUNT + 1) * 10 + 6;
+        DrawRectangle(screen, OVERLAY_X, OVERLAY_Y, w, h, boxColor, boxColor);
+        for (int i = 0; i <= PHASE_COUNT; i++) {
+                DrawTextLine(screen, cache, TEXT_PROFILE + i, OVERLAY_X + 4, OVERLAY_Y + 4 + i * 10);
         }
-        return false;
+        MarkDirty(dirty, OVERLAY_X, OVERLAY_Y, w, h);
 }
+#endif
 
-// -------------
-// DOT FUNCTIONS
-// -------------
+// Function to prepare an empty replay of a game that was just started and the camera over its head
+void StartGame(Game* game, Replay* replay, Camera* camera) {
+        InitReplay(replay, game->seed, game->snake.width, game->snake.height);
+        Segment head = SnakeSegment(&game->snake, 0);
+        InitCamera(camera, game->snake.width, game->snake.height, &head);
+        printf("New game, seed %llu\n", (unsigned long long)game->seed);
+}
 
-// Function to initialize the blue dot
-void InitDot(Dot* blueDot, Snake* snake) {
-        bool flag = false;
-        while (!flag) {
-                flag = true;
-                blueDot->x = rand() % ROW_CELLS;
-                blueDot->y = rand() % COL_CELLS;
-                for (int i = 0; i < snake->length; i++) {
-                        if (snake->body[i].x == blueDot->x && snake->body[i].y == blueDot->y) {
-                                flag = false;
-                                break;
-                        }
-                }
+// Function to save the replay of the game to the file given with --record (NULL when nothing is recorded)
+void SaveRecording(Replay* replay, Game* game, const char* path) {
+        if (path == NULL) {
+                return;
+        }
+        replay->moves = game->moves;
+        if (!SaveReplay(replay, path)) {
+                printf("Cannot save the replay to %s\n", path);
         }
 }
 
-// Function to check if the snake has eaten the blue dot
-bool checkDotCollision(Dot* blueDot, Snake* snake) {
-        if (snake->body[0].x == blueDot->x && snake->body[0].y == blueDot->y) {
-                return true;
+// Function to turn the snake and record the turn, returns false when the turn was not accepted
+bool TurnAndRecord(Game* game, Replay* replay, int direction) {
+        if (!TurnSnake(game, direction)) {
+                return false;
         }
-        return false;
+        RecordTurn(replay, game->moves, direction);
+        return true;
 }
 
-// --------------
-// GAME FUNCTIONS
-// --------------
+// Function to add the time from a key press to the move that made its turn
+void AddLatency(InputLatency* latency, double ms) {
+        latency->totalMs += ms;
+        if (ms > latency->maxMs) {
+                latency->maxMs = ms;
+        }
+        latency->samples++;
+}
 
-// Function the GameOver message
-void DisplayGameOver(SDL_Surface* screen, SDL_Surface* charset, char* text) {
-        sprintf(text, "Game Over!");
-        DrawString(screen, screen->w / 2 - strlen(text) * 4, 45, text, charset);
+// ----------------
+// EXPORT FUNCTIONS
+// ----------------
 
-        sprintf(text, "Press 'n' for a new game or 'Esc' to exit");
-        DrawString(screen, screen->w / 2 - strlen(text) * 4, 60, text, charset);
+// Function to make the turns for the coming move, from the replay being played or from the autopilot
+void MakeExportTurns(Game* game, Replay* play, int* nextTurn, Autopilot* pilot, int autopilot) {
+        if (play != NULL) {
+                while (*nextTurn < play->turnCount && play->turns[*nextTurn].move == game->moves) {
+                        TurnSnake(game, play->turns[*nextTurn].direction);
+                        (*nextTurn)++;
+                }
+        }
+        else if (autopilot) {
+                int action = AutopilotDecide(pilot, game);
+                if (action != ACTION_NONE) {
+                        TurnSnake(game, action);
+                }
+        }
 }
 
-// Function to display the game information
-void DisplayInfoText(SDL_Surface* screen, SDL_Surface* charset, char* text, double worldTime) {
-        sprintf(text, "Jan Rudnicki 203179 - Snake, Time = %.1lf s, Implemented Requirements: 1-4,A,B", worldTime);
-        DrawString(screen, screen->w / 2 - strlen(text) * 8 / 2, 10, text, charset);
-        sprintf(text, "Esc - exit, n - new game, Move the snake using arrow keys");
-        DrawString(screen, screen->w / 2 - strlen(text) * 8 / 2, 26, text, charset);
-}
+// Function to play the game without a window and write every frame to the video file at path (.y4m or raw RGB)
+// The game time advances by exactly 1 / fps for every frame, so the video runs at the speed of the game no matter how
+// long the frames take. The frames are drawn straight into the queue of the writer, whose thread converts and writes them.
+// The turns come from the replay play (NULL if there is none) or from the autopilot, returns the exit code of the program
+int ExportVideo(const char* path, int fps, double seconds, Game* game, Replay* play, int autopilot) {
+        size_t length = strlen(path);
+        int format = length >= 4 && strcmp(path + length - 4, ".y4m") == 0 ? VIDEO_Y4M : VIDEO_RGB;
+        VideoWriter video;
+        if (!InitVideoWriter(&video, path, format, SCREEN_WIDTH, SCREEN_HEIGHT, fps)) {
+                printf("Cannot create the video file %s\n", path);
+                return 1;
+        }
+        // Every slot of the queue is wrapped in a surface once, the drawing functions draw into them
+        SDL_Surface* slots[VIDEO_QUEUE_FRAMES];
+        for (int i = 0; i < VIDEO_QUEUE_FRAMES; i++) {
+                slots[i] = SDL_CreateRGBSurfaceWithFormatFrom(VideoFramePixels(&video, i), SCREEN_WIDTH, SCREEN_HEIGHT, 32, SCREEN_WIDTH * 4, SDL_PIXELFORMAT_ARGB8888);
+        }
+        SDL_Surface* charset = CreateFontSurface();
+        SDL_Surface* blueDotSurface = CreateDotSurface();
+        TextCache textCache;
+        BackgroundCache background;
+        InitBackground(&background);
+        bool ready = charset != NULL && blueDotSurface != NULL;
+        for (int i = 0; i < VIDEO_QUEUE_FRAMES; i++) {
+                ready = ready && slots[i] != NULL;
+        }
+        // The text cache reads the format of the first slot, so it is prepared only when every surface exists
+        bool textReady = ready && InitTextCache(&textCache, charset, slots[0]);
+        if (!textReady) {
+                printf("SDL error: %s\n", SDL_GetError());
+                if (ready) {
+                        FreeTextCache(&textCache);
+                }
+                for (int i = 0; i < VIDEO_QUEUE_FRAMES; i++) {
+                        SDL_FreeSurface(slots[i]);
+                }
+                SDL_FreeSurface(charset);
+                SDL_FreeSurface(blueDotSurface);
+                FreeVideoWriter(&video);
+                return 1;
+        }
+        int czarny = SDL_MapRGB(slots[0]->format, 0x00, 0x00, 0x00);
+        int bialy = SDL_MapRGB(slots[0]->format, 0xFF, 0xFF, 0xFF);
+        int szary = SDL_MapRGB(slots[0]->format, 0x80, 0x80, 0x80);
+        int czerwony = SDL_MapRGB(slots[0]->format, 0xFF, 0x00, 0x00);
+        int zielony = SDL_MapRGB(slots[0]->format, 0x00, 0xFF, 0x00);
+
+        Camera camera;
+        Segment head = SnakeSegment(&game->snake, 0);
+        InitCamera(&camera, game->snake.width, game->snake.height, &head);
+        Autopilot pilot;
+        InitAutopilot(&pilot, game->snake.width, game->snake.height);
+        int nextTurn = 0;
+        int endFrames = 0;
+        long long frames = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        while (endFrames < EXPORT_END_FRAMES) {
+                // Compose the whole frame in a free slot of the queue
+                SDL_Surface* frame = slots[AcquireVideoFrame(&video)];
+                PrepareBackground(&background, frame, &camera, czarny, czerwony, czarny, szary);
+                RestoreBackground(frame, &background, NULL);
+                DrawSnake(frame, &game->snake, &camera, czerwony, zielony, bialy);
+                if (!game->gameWon) {
+                        DrawDot(frame, blueDotSurface, &game->blueDot, &camera);
+                }
+                if (game->gameOver) {
+                        DisplayGameOver(frame, &textCache, game->gameWon);
+                }
+                DisplayInfoText(frame, &textCache, game->worldTime);
+                SubmitVideoFrame(&video);
+                frames++;
+
+                // The video ends a little after the game, the replay or the time given for it
+                if (game->gameOver || game->worldTime >= seconds || (play != NULL && game->moves >= play->moves)) {
+                        endFrames++;
+                        continue;
+                }
+                AddGameTime(game, 1.0 / fps);
+                while (TakeMove(game)) {
+                        MakeExportTurns(game, play, &nextTurn, &pilot, autopilot);
+                        StepGame(game, ACTION_NONE);
+                        head = SnakeSegment(&game->snake, 0);
+                        FollowHead(&camera, &head);
+                }
+        }
+        bool written = FreeVideoWriter(&video);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        printf("Exported %lld frames (%.1lf s at %d fps) to %s: %.1lf frames/s, %.1lf MB\n", frames, (double)frames / fps, fps, path,
+                frames / elapsed, video.bytesWritten / 1e6);
+        printf("The queue was full %lld times, drawing waited %.3lf s for the writer\n", video.waits, video.waitSeconds);
+        if (!written) {
+                printf("Cannot write the video file %s\n", path);
+        }
 
-// Function to free all the memory
-void FreeMemory(Snake* snake, Dot* blueDot) {
-        delete[] snake->body;
-        delete snake;
-        delete blueDot;
+        FreeAutopilot(&pilot);
+        FreeBackground(&background);
+        FreeTextCache(&textCache);
+        for (int i = 0; i < VIDEO_QUEUE_FRAMES; i++) {
+                SDL_FreeSurface(slots[i]);
+        }
+        SDL_FreeSurface(charset);
+        SDL_FreeSurface(blueDotSurface);
+        return written ? 0 : 1;
 }
 
 // -------------
@@ -376,7 +525,96 @@ extern "C"
 #endif
 int main(int argc, char** argv) {
 
-        srand(time(NULL));
+        // Frame rate: --fps N limits the frames per second (0 = no limit), --vsync waits for the display instead
+        int targetFps = DEFAULT_FPS;
+        int vsync = 0;
+        // --seed N starts the first game with the given seed, --record FILE saves the replay of the game to FILE
+        uint64_t seed = (uint64_t)time(NULL);
+        const char* recordPath = NULL;
+        // --board WxH plays on a board of W x H cells, a board larger than the window is followed by the camera
+        int boardWidth = ROW_CELLS;
+        int boardHeight = COL_CELLS;
+        // --autopilot lets the autopilot drive the snake from the start, 'a' switches it on and off
+        int autopilot = 0;
+        // --export FILE plays the game without a window and saves it as a video, --play FILE takes its turns from a replay
+        const char* exportPath = NULL;
+        int exportFps = EXPORT_FPS;
+        double exportSeconds = EXPORT_SECONDS;
+        const char* playPath = NULL;
+#ifdef SNAKE_PROFILER
+        const char* tracePath = NULL;
+#endif
+        for (int i = 1; i < argc; i++) {
+                if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+                        targetFps = atoi(argv[++i]);
+                }
+                else if (strcmp(argv[i], "--vsync") == 0) {
+                        vsync = 1;
+                        targetFps = 0;
+                }
+                else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+                        seed = strtoull(argv[++i], NULL, 10);
+                }
+                else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+                        recordPath = argv[++i];
+                }
+                else if (strcmp(argv[i], "--autopilot") == 0) {
+                        autopilot = 1;
+                }
+                else if (strcmp(argv[i], "--export") == 0 && i + 1 < argc) {
+                        exportPath = argv[++i];
+                }
+                else if (strcmp(argv[i], "--export-fps") == 0 && i + 1 < argc) {
+                        exportFps = atoi(argv[++i]);
+                        if (exportFps <= 0) {
+                                exportFps = EXPORT_FPS;
+                        }
+                }
+                else if (strcmp(argv[i], "--export-seconds") == 0 && i + 1 < argc) {
+                        exportSeconds = atof(argv[++i]);
+                }
+                else if (strcmp(argv[i], "--play") == 0 && i + 1 < argc) {
+                        playPath = argv[++i];
+                }
+                else if (strcmp(argv[i], "--board") == 0 && i + 1 < argc) {
+                        int width, height;
+                        if (sscanf(argv[++i], "%dx%d", &width, &height) == 2 && BoardSizeAllowed(width, height)) {
+                                boardWidth = width;
+                                boardHeight = height;
+                        }
+                        else {
+                                printf("Wrong board size %s, playing on %dx%d\n", argv[i], boardWidth, boardHeight);
+                        }
+                }
+#ifdef SNAKE_PROFILER
+                // --trace FILE saves the timed phases of every frame as a Chrome trace when the game exits
+                else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+                        tracePath = argv[++i];
+                }
+#endif
+        }
+
+        // A video is made without a window, SDL is only used for its surfaces
+        if (exportPath != NULL) {
+                Replay play;
+                if (playPath != NULL && !LoadReplay(&play, playPath)) {
+                        printf("Cannot read the replay %s\n", playPath);
+                        return 1;
+                }
+                Game game;
+                if (playPath != NULL) {
+                        InitGameOfSize(&game, play.seed, play.width, play.height);
+                }
+                else {
+                        InitGameOfSize(&game, seed, boardWidth, boardHeight);
+                }
+                int code = ExportVideo(exportPath, exportFps, exportSeconds, &game, playPath != NULL ? &play : NULL, autopilot);
+                FreeGame(&game);
+                if (playPath != NULL) {
+                        FreeReplay(&play);
+                }
+                return code;
+        }
 
         SDL_Event event;
         SDL_Window* window;
@@ -388,6 +626,11 @@ int main(int argc, char** argv) {
                 return 1;
         }
 
+        // The hint has to be set before the renderer is created
+        if (vsync) {
+                SDL_SetHint(SDL_HINT_RENDER_VSYNC, "1");
+        }
+
         // rc = SDL_CreateWindowAndRenderer(0, 0, SDL_WINDOW_FULLSCREEN_DESKTOP, &window, &renderer);
         int rc = SDL_CreateWindowAndRenderer(SCREEN_WIDTH, SCREEN_HEIGHT, 0, &window, &renderer);
         if (rc != 0) {
@@ -408,30 +651,20 @@ int main(int argc, char** argv) {
         // turning of the cursor
         SDL_ShowCursor(SDL_DISABLE);
 
-        SDL_Surface* charset = SDL_LoadBMP("./cs8x8.bmp");
-        if (charset == NULL) {
-                printf("SDL_LoadBMP(cs8x8.bmp) error: %s\n", SDL_GetError());
-                SDL_FreeSurface(screen);
-                SDL_DestroyTexture(scrtex);
-                SDL_DestroyWindow(window);
-                SDL_DestroyRenderer(renderer);
-                SDL_Quit();
-                return 1;
-        }
-        SDL_SetColorKey(charset, true, 0x000000);
-
-        SDL_Surface* blueDotSurface = SDL_LoadBMP("./blue_dot.bmp");
-        if (blueDotSurface == NULL) {
-                printf("SDL_LoadBMP(blue_dot.bmp) error: %s\n", SDL_GetError());
+        // The font and the dot are compiled into the game, no file is read
+        SDL_Surface* charset = CreateFontSurface();
+        SDL_Surface* blueDotSurface = CreateDotSurface();
+        if (charset == NULL || blueDotSurface == NULL) {
+                printf("SDL_CreateRGBSurfaceWithFormatFrom error: %s\n", SDL_GetError());
                 SDL_FreeSurface(screen);
                 SDL_FreeSurface(charset);
+                SDL_FreeSurface(blueDotSurface);
                 SDL_DestroyTexture(scrtex);
                 SDL_DestroyWindow(window);
                 SDL_DestroyRenderer(renderer);
                 SDL_Quit();
                 return 1;
         }
-        SDL_SetColorKey(blueDotSurface, true, 0x000000);
 
         // Initialize the colors
         int czarny = SDL_MapRGB(screen->format, 0x00, 0x00, 0x00);
@@ -439,82 +672,74 @@ int main(int argc, char** argv) {
         int szary = SDL_MapRGB(screen->format, 0x80, 0x80, 0x80);
         int czerwony = SDL_MapRGB(screen->format, 0xFF, 0x00, 0x00);
         int zielony = SDL_MapRGB(screen->format, 0x00, 0xFF, 0x00);
-        int niebieski = SDL_MapRGB(screen->format, 0x11, 0x11, 0xCC);
+#ifdef SNAKE_PROFILER
+        int niebieski = SDL_MapRGB(screen->format, 0x11, 0x11, 0xCC); // the background of the profiler overlay
+#endif
 
         // Text variables
-        char text[128];
+        // The lines of the info area and the messages are drawn from surfaces prepared in the screen format
+        TextCache textCache;
+        if (!InitTextCache(&textCache, charset, screen)) {
+                printf("SDL_ConvertSurface(font) error: %s\n", SDL_GetError());
+                SDL_FreeSurface(screen);
+                SDL_FreeSurface(charset);
+                SDL_FreeSurface(blueDotSurface);
+                SDL_DestroyTexture(scrtex);
+                SDL_DestroyWindow(window);
+                SDL_DestroyRenderer(renderer);
+                SDL_Quit();
+                return 1;
+        }
+
+        // Rendering variables, the first frame is always drawn completely
+        DirtyRects dirty;
+        ClearDirty(&dirty);
+        dirty.full = 1;
+        BackgroundCache background;
+        InitBackground(&background);
 
         // Time variables
-        double worldTime = 0;
-        double snakeTime = 0;
-        double speedupTime = 0;
-        int t1 = SDL_GetTicks();
-        int t2;
+        Uint64 frequency = SDL_GetPerformanceFrequency();
+        Uint64 t1 = SDL_GetPerformanceCounter();
+        Uint64 t2;
         double delta;
 
+        // Frame pacing variables
+        FramePacer pacer;
+        InitFramePacer(&pacer, targetFps);
+        char title[96];
+
+#ifdef SNAKE_PROFILER
+        // Profiler variables, F3 shows or hides the overlay
+        Profiler profiler;
+        InitProfiler(&profiler, tracePath != NULL);
+        PrepareProfileText(&textCache, &profiler);
+        int showProfile = 1;
+#endif
+
         // Game variables
-        int canMove = 0;
-        int gameOver = 0;
         int quit = 0;
-
-        // Allocate memory for the snake
-        Snake* snake = new Snake;
-        InitSnake(snake);
-
-        // Allocate memory for the blue dot
-        Dot* blueDot = new Dot;
-        InitDot(blueDot, snake);
+        int paused = 0;
+        Game game;
+        Replay replay;
+        Camera camera;
+        // The seeds of the next games follow from the first one, so a whole session can be played again
+        Random seeds;
+        SeedRandom(&seeds, seed);
+        InitGameOfSize(&game, seed, boardWidth, boardHeight);
+        StartGame(&game, &replay, &camera);
+        int recorded = 0;
+        Autopilot pilot;
+        InitAutopilot(&pilot, boardWidth, boardHeight);
+        InputLatency latency = { 0, 0, 0 };
 
         while (!quit) {
 
-                t2 = SDL_GetTicks();
-                delta = (t2 - t1) * 0.001; // get the time in seconds
-                t1 = t2;
-
-                if (!gameOver) {
-                        worldTime += delta;
-                        speedupTime += delta;
-                        snakeTime += delta;
-                        // If ennough time has passed since the last move, the snake moves
-                        if (snakeTime >= snake->speed) {
-                                UpdateSnake(snake);
-                                canMove = 1;
-                                snakeTime = 0;
-                        }
-                        // If enough time has passed since the last speedup, the snake speeds up
-                        if (speedupTime >= SPEEDUP_TIME) {
-                                SpeedUp(snake);
-                                speedupTime = 0;
-                        }
-                        // Check if the snake has eaten the blue dot
-                        if (checkDotCollision(blueDot, snake)) {
-                                InitDot(blueDot, snake);
-                                growSnake(snake);
-                        }
-                }
-
-                // Clear the screen
-                SDL_FillRect(screen, NULL, czarny);
-
-                // Draw everything on the screen
-                DrawRectangle(screen, 0, 0, SCREEN_WIDTH, INFO_AREA_HEIGHT, czarny, czerwony);
-                DrawRectangle(screen, 0, INFO_AREA_HEIGHT, SCREEN_WIDTH, GAME_BOARD_HEIGHT, czarny, czarny);
-                DrawGrid(screen, szary);
-                DrawSnake(screen, snake, czerwony, zielony, bialy);
-                DrawDot(screen, blueDotSurface, blueDot);
-
-                // Check if the snake collided with itself
-                if (checkCollision(snake)) {
-                        gameOver = 1;
-                        DisplayGameOver(screen, charset, text);
-                }
-
-                // Display the information text
-                DisplayInfoText(screen, charset, text, worldTime);
-                SDL_UpdateTexture(scrtex, NULL, screen->pixels, screen->pitch);
-                SDL_RenderCopy(renderer, scrtex, NULL, NULL);
-                SDL_RenderPresent(renderer);
+                BeginFrame(&pacer);
+                PROFILE_BEGIN(&profiler, PHASE_FRAME);
 
+                // The events are handled first, so the turns given while the last frame waited are made by the moves of this one
+                PROFILE_BEGIN(&profiler, PHASE_EVENTS);
                 while (SDL_PollEvent(&event)) {
                         switch (event.type) {
                         case SDL_KEYDOWN:
@@ -524,52 +749,213 @@ int main(int argc, char** argv) {
                                 }
                                 else if (event.key.keysym.sym == SDLK_n) {
                                         // If the 'n' key is pressed, start a new game
-                                        FreeMemory(snake, blueDot);
-                                        snake = new Snake;
-                                        InitSnake(snake);
-                                        blueDot = new Dot;
-                                        InitDot(blueDot, snake);
-                                        gameOver = 0;
-                                        worldTime = 0;
-                                        snakeTime = 0;
-                                        speedupTime = 0;
-                                        canMove = 0;
+                                        if (!recorded) {
+                                                SaveRecording(&replay, &game, recordPath);
+                                        }
+                                        // The next game is played in the memory of this one
+                                        FreeReplay(&replay);
+                                        ResetGame(&game, NextRandom(&seeds));
+                                        StartGame(&game, &replay, &camera);
+                                        ResetAutopilot(&pilot);
+                                        recorded = 0;
+                                        paused = 0;
+                                        dirty.full = 1;
+                                        // The time spent waiting on the finished game does not count
+                                        t1 = SDL_GetPerformanceCounter();
+                                }
+                                else if (event.key.keysym.sym == SDLK_p) {
+                                        // If the 'p' key is pressed, pause or resume the game
+                                        if (!game.gameOver) {
+                                                paused = !paused;
+                                                dirty.full = 1;
+                                                t1 = SDL_GetPerformanceCounter();
+                                        }
                                 }
-                                else if (!gameOver && canMove) { //Checking if the game is not over and the snake can move
-                                        if (event.key.keysym.sym == SDLK_RIGHT && (snake->direction != LEFT || snake->length==1)) {
-                                                if (snake->body[0].x < ROW_CELLS - 1) {
-                                                        snake->direction = RIGHT;
-                                                        canMove = 0;
-                                                }
+                                else if (event.key.keysym.sym == SDLK_a) {
+                                        // If the 'a' key is pressed, the autopilot takes over the snake or gives it back
+                                        autopilot = !autopilot;
+                                        ResetAutopilot(&pilot);
+                                        game.turnCount = 0;
+                                }
+#ifdef SNAKE_PROFILER
+                                else if (event.key.keysym.sym == SDLK_F3) {
+                                        // F3 shows or hides the profiler overlay, the board under it has to be drawn again
+                                        showProfile = !showProfile;
+                                        dirty.full = 1;
+                                }
+#endif
+                                else if (!paused && !autopilot) {
+                                        // The snake does not turn while the game is paused or driven by the autopilot
+                                        // The turns wait in the queue of the game for the next moves, the time of the key press is kept
+                                        if (event.key.keysym.sym == SDLK_RIGHT) {
+                                                QueueTurn(&game, RIGHT, event.key.timestamp / 1000.0);
                                         }
-                                        else if (event.key.keysym.sym == SDLK_LEFT && (snake->direction != RIGHT || snake->length==1)) {
-                                                if (snake->body[0].x > 0) {
-                                                        snake->direction = LEFT;
-                                                        canMove = 0;
-                                                }
+                                        else if (event.key.keysym.sym == SDLK_LEFT) {
+                                                QueueTurn(&game, LEFT, event.key.timestamp / 1000.0);
                                         }
-                                        else if (event.key.keysym.sym == SDLK_UP && (snake->direction != DOWN || snake->length==1)) {
-                                                if (snake->body[0].y > 0) {
-                                                        snake->direction = UP;
-                                                        canMove = 0;
-                                                }
+                                        else if (event.key.keysym.sym == SDLK_UP) {
+                                                QueueTurn(&game, UP, event.key.timestamp / 1000.0);
                                         }
-                                        else if (event.key.keysym.sym == SDLK_DOWN && (snake->direction != UP || snake->length==1)) {
-                                                if (snake->body[0].y < COL_CELLS - 1) {
-                                                        snake->direction = DOWN;
-                                                        canMove = 0;
-                                                }
+                                        else if (event.key.keysym.sym == SDLK_DOWN) {
+                                                QueueTurn(&game, DOWN, event.key.timestamp / 1000.0);
                                         }
                                 }
                                 break;
+                        case SDL_WINDOWEVENT:
+                                // The window was resized or uncovered, its content has to be drawn again
+                                if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED || event.window.event == SDL_WINDOWEVENT_EXPOSED) {
+                                        dirty.full = 1;
+                                }
+                                break;
                         case SDL_QUIT:
                                 quit = 1;
                                 break;
                         }
                 }
+                PROFILE_END(&profiler, PHASE_EVENTS);
+
+                t2 = SDL_GetPerformanceCounter();
+                delta = (double)(t2 - t1) / frequency; // get the time in seconds
+                t1 = t2;
+
+                // Make every move that is due by now, the frame is drawn once after all of them
+                // While the game is paused its time stands still
+                PROFILE_BEGIN(&profiler, PHASE_LOGIC);
+                if (!paused) {
+                        AddGameTime(&game, delta);
+                        while (TakeMove(&game)) {
+                                // Every move makes the next queued turn of the player, the turns of the autopilot are recorded the same way
+                                if (autopilot) {
+                                        int action = AutopilotDecide(&pilot, &game);
+                                        if (action != ACTION_NONE) {
+                                                TurnAndRecord(&game, &replay, action);
+                                        }
+                                }
+                                else {
+                                        double pressTime;
+                                        int turn = TakeQueuedTurn(&game, &pressTime);
+                                        if (turn != ACTION_NONE && TurnAndRecord(&game, &replay, turn)) {
+                                                AddLatency(&latency, (SDL_GetTicks() / 1000.0 - pressTime) * 1000);
+                                        }
+                                }
+                                StepGameDirty(&game, &camera, &dirty);
+                        }
+                        if (game.gameOver && !recorded) {
+                                SaveRecording(&replay, &game, recordPath);
+                                recorded = 1;
+                        }
+                }
+                PROFILE_END(&profiler, PHASE_LOGIC);
+
+                // The static layer is drawn only once, a new one has to be put on the whole screen
+                PROFILE_BEGIN(&profiler, PHASE_BACKGROUND);
+                if (PrepareBackground(&background, screen, &camera, czarny, czerwony, czarny, szary)) {
+                        dirty.full = 1;
+                }
+                // The rectangles of the info time and the overlay have to fit after the cells
+                if (dirty.count > MAX_DIRTY_RECTS - HUD_DIRTY_RECTS) {
+                        dirty.full = 1;
+                }
+
+                // A whole frame is drawn straight into the texture, the screen surface only keeps the cells
+                // repainted by the other frames until they are uploaded
+                SDL_Surface* frame = NULL;
+                if (dirty.full) {
+                        frame = LockFrame(scrtex);
+                }
+                SDL_Surface* target = frame != NULL ? frame : screen;
+
+                if (dirty.full) {
+                        // Restore the static layer: info bar, board background and grid
+                        RestoreBackground(target, &background, NULL);
+                        PROFILE_END(&profiler, PHASE_BACKGROUND);
+
+                        // Draw everything on the screen
+                        PROFILE_BEGIN(&profiler, PHASE_DRAW);
+                        DrawSnake(target, &game.snake, &camera, czerwony, zielony, bialy);
+                        if (!game.gameWon) {
+                                DrawDot(target, blueDotSurface, &game.blueDot, &camera);
+                        }
+                        if (game.gameOver) {
+                                DisplayGameOver(target, &textCache, game.gameWon);
+                        }
+                        else if (paused) {
+                                DisplayPaused(target, &textCache);
+                        }
+                        PROFILE_END(&profiler, PHASE_DRAW);
+
+                        // Display the information text
+                        PROFILE_BEGIN(&profiler, PHASE_TEXT);
+                        DisplayInfoText(target, &textCache, game.worldTime);
+                }
+                else {
+                        PROFILE_END(&profiler, PHASE_BACKGROUND);
+
+                        // Repaint only the cells that changed since the last frame
+                        PROFILE_BEGIN(&profiler, PHASE_DRAW);
+                        int cells = dirty.count;
+                        for (int i = 0; i < cells; i++) {
+                                int x = camera.x + dirty.rects[i].x / CELL_SIZE;
+                                int y = camera.y + (dirty.rects[i].y - INFO_AREA_HEIGHT) / CELL_SIZE;
+                                RedrawCell(screen, &background, &camera, &game.snake, &game.blueDot, blueDotSurface, !game.gameWon, x, y, czerwony, zielony, bialy);
+                        }
+                        PROFILE_END(&profiler, PHASE_DRAW);
+
+                        PROFILE_BEGIN(&profiler, PHASE_TEXT);
+                        UpdateInfoTime(screen, &textCache, &background, game.worldTime, &dirty);
+                }
+#ifdef SNAKE_PROFILER
+                // The overlay is drawn again every frame, over the cells that were repainted under it
+                if (UpdateProfileStats(&profiler)) {
+                        PrepareProfileText(&textCache, &profiler);
+                }
+                if (showProfile) {
+                        DisplayProfile(target, &textCache, niebieski, &dirty);
+                }
+#endif
+                PROFILE_END(&profiler, PHASE_TEXT);
+
+                // Only the changed rectangles are copied, a frame drawn into the texture needs no copy at all
+                PROFILE_BEGIN(&profiler, PHASE_UPLOAD);
+                if (frame != NULL) {
+                        UnlockFrame(scrtex, frame);
+                }
+                else {
+                        UploadDirty(scrtex, screen, &dirty);
+                }
+                ClearDirty(&dirty);
+                PROFILE_END(&profiler, PHASE_UPLOAD);
+
+                PROFILE_BEGIN(&profiler, PHASE_PRESENT);
+                SDL_RenderCopy(renderer, scrtex, NULL, NULL);
+                SDL_RenderPresent(renderer);
+                PROFILE_END(&profiler, PHASE_PRESENT);
+
+                PROFILE_END(&profiler, PHASE_FRAME);
+
+                // Nothing changes on a finished or paused game, so the loop waits for the next event
+                int idle = game.gameOver || paused;
+                PROFILE_BEGIN(&profiler, PHASE_WAIT);
+                if (EndFrame(&pacer, idle)) {
+                        int length = sprintf(title, "Snake Game - %.1lf FPS, %.2lf ms busy/frame", pacer.fps, pacer.busyMs);
+                        if (autopilot && pilot.decisions > 0) {
+                                length += sprintf(title + length, ", autopilot %.1lf us/move", pilot.totalNs / 1000.0 / pilot.decisions);
+                        }
+                        // The latency of the turns made since the last statistics, the average and the longest
+                        if (latency.samples > 0) {
+                                sprintf(title + length, ", input %.0lf/%.0lf ms", latency.totalMs / latency.samples, latency.maxMs);
+                                latency.totalMs = 0;
+                                latency.maxMs = 0;
+                                latency.samples = 0;
+                        }
+                        SDL_SetWindowTitle(window, title);
+                }
+                PROFILE_END(&profiler, PHASE_WAIT);
         }
 
         // Freeing all surfaces
+        FreeBackground(&background);
+        FreeTextCache(&textCache);
         SDL_FreeSurface(charset);
         SDL_FreeSurface(screen);
         SDL_FreeSurface(blueDotSurface);
@@ -577,8 +963,19 @@ int main(int argc, char** argv) {
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
 
-        // Freeing all memory
-        FreeMemory(snake, blueDot);
+        // Freeing all memory, the replay of an unfinished game is saved first
+        if (!recorded) {
+                SaveRecording(&replay, &game, recordPath);
+        }
+        FreeGame(&game);
+        FreeReplay(&replay);
+        FreeAutopilot(&pilot);
+#ifdef SNAKE_PROFILER
+        if (tracePath != NULL && !SaveTrace(&profiler, tracePath)) {
+                printf("Cannot save the trace to %s\n", tracePath);
+        }
+        FreeProfiler(&profiler);
+#endif
 
         // Quit SDL
         SDL_Quit();
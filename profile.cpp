@@ -0,0 +1,161 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// profile: timing the phases of a frame, with statistics for the overlay and a trace for chrome://tracing
+
+#include<stdio.h>
+#include<string.h>
+
+#include"profile.h"
+
+#ifdef SNAKE_PROFILER
+
+const char* PHASE_NAMES[PHASE_COUNT] = { "frame", "logic", "background", "draw", "text", "upload", "present", "events", "wait" };
+
+// -------------------
+// HISTOGRAM FUNCTIONS
+// -------------------
+
+// Function to get the histogram bucket of a duration in nanoseconds
+// Below 4 ns every value has its own bucket, above it every power of two is split into 4 buckets
+static int BucketOf(Uint64 ns) {
+        if (ns < 4) {
+                return (int)ns;
+        }
+        int octave = 2;
+        while ((ns >> (octave + 1)) != 0) {
+                octave++;
+        }
+        int bucket = (octave - 1) * 4 + (int)((ns >> (octave - 2)) & 3);
+        return bucket < PROFILE_BUCKETS ? bucket : PROFILE_BUCKETS - 1;
+}
+
+// Function to get the largest duration in nanoseconds that falls into a bucket
+static double BucketLimit(int bucket) {
+        if (bucket < 4) {
+                return bucket + 1;
+        }
+        int octave = bucket / 4 + 1;
+        return (double)((Uint64)(5 + bucket % 4) << (octave - 2));
+}
+
+// Function to empty the histogram of a phase
+static void ClearHistogram(PhaseHistogram* histogram) {
+        memset(histogram->counts, 0, sizeof(histogram->counts));
+        histogram->minTicks = ~(Uint64)0;
+        histogram->totalTicks = 0;
+        histogram->samples = 0;
+}
+
+// ------------------
+// PROFILER FUNCTIONS
+// ------------------
+
+// Function to start the profiler with empty statistics
+void InitProfiler(Profiler* profiler, int trace) {
+        profiler->frequency = SDL_GetPerformanceFrequency();
+        profiler->origin = SDL_GetPerformanceCounter();
+        profiler->windowStart = profiler->origin;
+        for (int i = 0; i < PHASE_COUNT; i++) {
+                profiler->begin[i] = profiler->origin;
+                ClearHistogram(&profiler->window[i]);
+                memset(&profiler->stats[i], 0, sizeof(PhaseStats));
+        }
+        profiler->trace = trace ? new TraceEvent[PROFILE_TRACE_EVENTS] : NULL;
+        profiler->traceCount = 0;
+        profiler->traceDropped = 0;
+}
+
+// Function to mark the start of a phase
+void ProfileBegin(Profiler* profiler, int phase) {
+        profiler->begin[phase] = SDL_GetPerformanceCounter();
+}
+
+// Function to mark the end of a phase and add its duration to the histogram (and the trace)
+void ProfileEnd(Profiler* profiler, int phase) {
+        Uint64 end = SDL_GetPerformanceCounter();
+        Uint64 ticks = end - profiler->begin[phase];
+        PhaseHistogram* histogram = &profiler->window[phase];
+        histogram->counts[BucketOf((Uint64)(ticks * 1e9 / profiler->frequency))]++;
+        if (ticks < histogram->minTicks) {
+                histogram->minTicks = ticks;
+        }
+        histogram->totalTicks += ticks;
+        histogram->samples++;
+        if (profiler->trace != NULL) {
+                if (profiler->traceCount < PROFILE_TRACE_EVENTS) {
+                        TraceEvent* event = &profiler->trace[profiler->traceCount++];
+                        event->start = profiler->begin[phase] - profiler->origin;
+                        event->duration = ticks;
+                        event->phase = phase;
+                }
+                else {
+                        profiler->traceDropped++;
+                }
+        }
+}
+
+// Function to turn the histograms of a finished window into statistics and start a new window
+bool UpdateProfileStats(Profiler* profiler) {
+        Uint64 now = SDL_GetPerformanceCounter();
+        if ((now - profiler->windowStart) * 1000 < profiler->frequency * PROFILE_WINDOW_MS) {
+                return false;
+        }
+        double msPerTick = 1000.0 / profiler->frequency;
+        for (int i = 0; i < PHASE_COUNT; i++) {
+                PhaseHistogram* histogram = &profiler->window[i];
+                PhaseStats* stats = &profiler->stats[i];
+                stats->samples = histogram->samples;
+                if (histogram->samples == 0) {
+                        stats->minMs = 0;
+                        stats->avgMs = 0;
+                        stats->p99Ms = 0;
+                        continue;
+                }
+                stats->minMs = histogram->minTicks * msPerTick;
+                stats->avgMs = histogram->totalTicks * msPerTick / histogram->samples;
+                // the 99th percentile is the first bucket that leaves at most 1% of the samples above it
+                int above = histogram->samples;
+                int bucket = 0;
+                while (bucket < PROFILE_BUCKETS - 1) {
+                        above -= histogram->counts[bucket];
+                        if (above * 100 <= histogram->samples) {
+                                break;
+                        }
+                        bucket++;
+                }
+                stats->p99Ms = BucketLimit(bucket) / 1000000;
+                ClearHistogram(histogram);
+        }
+        profiler->windowStart = now;
+        return true;
+}
+
+// Function to write the trace as a JSON array of complete events, times in microseconds
+bool SaveTrace(Profiler* profiler, const char* path) {
+        if (profiler->trace == NULL) {
+                return false;
+        }
+        FILE* file = fopen(path, "w");
+        if (file == NULL) {
+                return false;
+        }
+        double usPerTick = 1000000.0 / profiler->frequency;
+        fprintf(file, "{\"traceEvents\":[\n");
+        for (int i = 0; i < profiler->traceCount; i++) {
+                TraceEvent* event = &profiler->trace[i];
+                // the phases lie inside their frame, so the viewer nests them under it
+                fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}%s\n",
+                        PHASE_NAMES[event->phase], event->start * usPerTick, event->duration * usPerTick,
+                        i + 1 < profiler->traceCount ? "," : "");
+        }
+        fprintf(file, "],\"otherData\":{\"droppedEvents\":%d}}\n", profiler->traceDropped);
+        return fclose(file) == 0;
+}
+
+// Function to free the memory of the profiler
+void FreeProfiler(Profiler* profiler) {
+        delete[] profiler->trace;
+        profiler->trace = NULL;
+}
+
+#endif
@@ -0,0 +1,101 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// profile: timing the phases of a frame, with statistics for the overlay and a trace for chrome://tracing
+//
+// Compiled in only with -DSNAKE_PROFILER, otherwise the PROFILE_ macros expand to nothing
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+extern "C" {
+#include"./SDL2-2.0.10/include/SDL.h"
+}
+
+// ------------------
+// DEFINING CONSTANTS
+// ------------------
+
+// The phases of a frame
+#define PHASE_FRAME 0 // the whole work on a frame, without waiting
+#define PHASE_LOGIC 1 // game moves
+#define PHASE_BACKGROUND 2 // preparing and restoring the static layer
+#define PHASE_DRAW 3 // the snake, the dot and the messages
+#define PHASE_TEXT 4 // the info text and the overlay
+#define PHASE_UPLOAD 5 // copying the changed parts of the screen into the texture
+#define PHASE_PRESENT 6 // SDL_RenderCopy and SDL_RenderPresent
+#define PHASE_EVENTS 7 // handling the events
+#define PHASE_WAIT 8 // sleeping until the next frame or waiting for an event
+#define PHASE_COUNT 9
+
+#define PROFILE_BUCKETS 128 // histogram buckets, 4 for every power of two nanoseconds
+#define PROFILE_WINDOW_MS 1000 // statistics are measured over windows of this many milliseconds
+#define PROFILE_TRACE_EVENTS 262144 // the most phases kept for the trace, later ones are dropped
+
+// -------------------
+// DEFINING STRUCTURES
+// -------------------
+
+// Durations of one phase measured in the current window
+struct PhaseHistogram {
+        Uint32 counts[PROFILE_BUCKETS];
+        Uint64 minTicks;
+        Uint64 totalTicks;
+        int samples;
+};
+
+// Statistics of one phase from the last complete window
+struct PhaseStats {
+        double minMs;
+        double avgMs;
+        double p99Ms; // upper bound of the histogram bucket holding the 99th percentile
+        int samples;
+};
+
+// One timed phase for the trace
+struct TraceEvent {
+        Uint64 start;
+        Uint64 duration;
+        int phase;
+};
+
+struct Profiler {
+        Uint64 frequency; // performance counter ticks per second
+        Uint64 origin; // counter value the trace times are counted from
+        Uint64 begin[PHASE_COUNT]; // counter value at which every phase began
+        Uint64 windowStart;
+        PhaseHistogram window[PHASE_COUNT];
+        PhaseStats stats[PHASE_COUNT];
+        TraceEvent* trace; // NULL when no trace is recorded
+        int traceCount;
+        int traceDropped;
+};
+
+extern const char* PHASE_NAMES[PHASE_COUNT];
+
+// ------------------
+// PROFILER FUNCTIONS
+// ------------------
+
+// start the profiler, trace tells if the phases are also kept for SaveTrace
+void InitProfiler(Profiler* profiler, int trace);
+
+void ProfileBegin(Profiler* profiler, int phase);
+void ProfileEnd(Profiler* profiler, int phase);
+
+// turn the finished window into stats, returns true once a window when they change
+bool UpdateProfileStats(Profiler* profiler);
+
+// write the recorded phases as Chrome trace JSON (chrome://tracing, Perfetto), false when the file cannot be written
+bool SaveTrace(Profiler* profiler, const char* path);
+
+void FreeProfiler(Profiler* profiler);
+
+#ifdef SNAKE_PROFILER
+#define PROFILE_BEGIN(profiler, phase) ProfileBegin(profiler, phase)
+#define PROFILE_END(profiler, phase) ProfileEnd(profiler, phase)
+#else
+#define PROFILE_BEGIN(profiler, phase)
+#define PROFILE_END(profiler, phase)
+#endif
+
+#endif
@@ -0,0 +1,120 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// raster: filling spans, lines and rectangles of 32-bit pixels without going pixel by pixel
+
+#include"raster.h"
+
+// Wide stores are picked at compile time, AVX2 needs -mavx2 (gcc/clang) or /arch:AVX2 (MSVC)
+#if defined(__AVX2__)
+#define RASTER_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RASTER_SSE2
+#endif
+
+#if defined(RASTER_AVX2)
+#include<immintrin.h>
+#elif defined(RASTER_SSE2)
+#include<emmintrin.h>
+#endif
+
+void RasterFillSpan(uint32_t* dst, int n, uint32_t color) {
+#if defined(RASTER_AVX2)
+        __m256i wide = _mm256_set1_epi32((int)color);
+        while (n >= 8) {
+                _mm256_storeu_si256((__m256i*)dst, wide);
+                dst += 8;
+                n -= 8;
+        }
+#endif
+#if defined(RASTER_SSE2)
+        __m128i quad = _mm_set1_epi32((int)color);
+        while (n >= 4) {
+                _mm_storeu_si128((__m128i*)dst, quad);
+                dst += 4;
+                n -= 4;
+        }
+#endif
+        while (n > 0) {
+                *dst++ = color;
+                n--;
+        }
+}
+
+// Function to cut the span [*start, *start + *length) to [0, limit), returns false when nothing is left
+static bool ClipSpan(int* start, int* length, int limit) {
+        if (*start < 0) {
+                *length += *start;
+                *start = 0;
+        }
+        if (*start + *length > limit) {
+                *length = limit - *start;
+        }
+        return *length > 0;
+}
+
+void RasterFillRect(RasterTarget* target, int x, int y, int w, int h, uint32_t color) {
+        if (!ClipSpan(&x, &w, target->w) || !ClipSpan(&y, &h, target->h)) {
+                return;
+        }
+        uint32_t* row = target->pixels + y * target->pitch + x;
+        for (int i = 0; i < h; i++) {
+                RasterFillSpan(row, w, color);
+                row += target->pitch;
+        }
+}
+
+void RasterHLine(RasterTarget* target, int x, int y, int l, uint32_t color) {
+        RasterFillRect(target, x, y, l, 1, color);
+}
+
+void RasterVLine(RasterTarget* target, int x, int y, int l, uint32_t color) {
+        if (x < 0 || x >= target->w || !ClipSpan(&y, &l, target->h)) {
+                return;
+        }
+        uint32_t* p = target->pixels + y * target->pitch + x;
+        for (int i = 0; i < l; i++) {
+                *p = color;
+                p += target->pitch;
+        }
+}
+
+void RasterRectangle(RasterTarget* target, int x, int y, int l, int k, uint32_t outlineColor, uint32_t fillColor) {
+        if (l <= 0 || k <= 0) {
+                return;
+        }
+        int left = x;
+        int right = x + l - 1;
+        int top = y;
+        int bottom = y + k - 1;
+        // visible part of the rectangle
+        int x0 = x;
+        int w = l;
+        int y0 = y;
+        int h = k;
+        if (!ClipSpan(&x0, &w, target->w) || !ClipSpan(&y0, &h, target->h)) {
+                return;
+        }
+        int x1 = x0 + w - 1;
+        uint32_t* row = target->pixels + y0 * target->pitch;
+        for (int j = y0; j < y0 + h; j++) {
+                if (j == top || j == bottom) {
+                        RasterFillSpan(row + x0, w, outlineColor);
+                }
+                else {
+                        // inner row: outline pixel, fill span, outline pixel
+                        int fillStart = x0 == left ? x0 + 1 : x0;
+                        int fillEnd = x1 == right ? x1 - 1 : x1;
+                        if (x0 == left) {
+                                row[left] = outlineColor;
+                        }
+                        if (fillEnd >= fillStart) {
+                                RasterFillSpan(row + fillStart, fillEnd - fillStart + 1, fillColor);
+                        }
+                        if (x1 == right && right != left) {
+                                row[right] = outlineColor;
+                        }
+                }
+                row += target->pitch;
+        }
+}
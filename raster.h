@@ -0,0 +1,33 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// raster: filling spans, lines and rectangles of 32-bit pixels without going pixel by pixel
+
+#ifndef RASTER_H
+#define RASTER_H
+
+#include<stdint.h>
+
+// A 32-bit pixel buffer the raster functions draw into, pitch is counted in pixels
+struct RasterTarget {
+        uint32_t* pixels;
+        int pitch;
+        int w;
+        int h;
+};
+
+// fill n pixels starting at dst with color, using the widest stores the compiler was allowed to use
+void RasterFillSpan(uint32_t* dst, int n, uint32_t color);
+
+// fill a rectangle of size w by h, clipped to the target
+void RasterFillRect(RasterTarget* target, int x, int y, int w, int h, uint32_t color);
+
+// draw a horizontal line of length l, clipped to the target
+void RasterHLine(RasterTarget* target, int x, int y, int l, uint32_t color);
+
+// draw a vertical line of length l, clipped to the target
+void RasterVLine(RasterTarget* target, int x, int y, int l, uint32_t color);
+
+// draw a rectangle of size l by k with a one pixel outline, outline and fill are written in a single pass
+void RasterRectangle(RasterTarget* target, int x, int y, int l, int k, uint32_t outlineColor, uint32_t fillColor);
+
+#endif
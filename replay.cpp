@@ -0,0 +1,250 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// replay: recording the turns of a game and playing them back, without SDL
+
+#include<stdio.h>
+#include<string.h>
+
+#include"replay.h"
+
+// ----------------
+// VARINT FUNCTIONS
+// ----------------
+
+// Function to append a number to the buffer, 7 bits per byte, the highest bit tells that more bytes follow
+static int WriteVarint(uint8_t* buffer, uint64_t value) {
+        int n = 0;
+        while (value >= 0x80) {
+                buffer[n++] = (uint8_t)(value | 0x80);
+                value >>= 7;
+        }
+        buffer[n++] = (uint8_t)value;
+        return n;
+}
+
+// Function to read a number written by WriteVarint, returns false when the data ends in the middle of it
+static bool ReadVarint(const uint8_t* data, long size, long* position, uint64_t* value) {
+        *value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+                if (*position >= size) {
+                        return false;
+                }
+                uint8_t byte = data[(*position)++];
+                *value |= (uint64_t)(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) {
+                        return true;
+                }
+        }
+        return false;
+}
+
+// ----------------
+// REPLAY FUNCTIONS
+// ----------------
+
+// Function to start an empty replay of a game with the given seed on a board of the given size
+void InitReplay(Replay* replay, uint64_t seed, int width, int height) {
+        replay->seed = seed;
+        replay->width = width;
+        replay->height = height;
+        replay->moves = 0;
+        replay->turnCount = 0;
+        replay->turnCapacity = 64;
+        replay->turns = new ReplayTurn[replay->turnCapacity];
+}
+
+// Function to add a turn to the replay, the array doubles when it is full
+void RecordTurn(Replay* replay, int move, int direction) {
+        if (replay->turnCount == replay->turnCapacity) {
+                ReplayTurn* turns = new ReplayTurn[replay->turnCapacity * 2];
+                memcpy(turns, replay->turns, sizeof(ReplayTurn) * replay->turnCount);
+                delete[] replay->turns;
+                replay->turns = turns;
+                replay->turnCapacity *= 2;
+        }
+        replay->turns[replay->turnCount].move = move;
+        replay->turns[replay->turnCount].direction = direction;
+        replay->turnCount++;
+        if (replay->moves < move) {
+                replay->moves = move;
+        }
+}
+
+// Function to save the replay to a file
+bool SaveReplay(Replay* replay, const char* path) {
+        // header, the board size, two counts and at most 5 bytes for every turn (a move number fits in 30 bits)
+        uint8_t* buffer = new uint8_t[13 + 10 + 20 + 5 * replay->turnCount];
+        int size = 0;
+        memcpy(buffer, "SNRP", 4);
+        size += 4;
+        buffer[size++] = REPLAY_VERSION;
+        for (int i = 0; i < 8; i++) {
+                buffer[size++] = (uint8_t)(replay->seed >> (8 * i));
+        }
+        size += WriteVarint(buffer + size, replay->width);
+        size += WriteVarint(buffer + size, replay->height);
+        size += WriteVarint(buffer + size, replay->moves);
+        size += WriteVarint(buffer + size, replay->turnCount);
+        int previous = 0;
+        for (int i = 0; i < replay->turnCount; i++) {
+                uint64_t delta = (uint64_t)(replay->turns[i].move - previous);
+                size += WriteVarint(buffer + size, (delta << 2) | (uint64_t)replay->turns[i].direction);
+                previous = replay->turns[i].move;
+        }
+
+        FILE* file = fopen(path, "wb");
+        bool saved = false;
+        if (file != NULL) {
+                saved = fwrite(buffer, 1, size, file) == (size_t)size;
+                saved = fclose(file) == 0 && saved;
+        }
+        delete[] buffer;
+        return saved;
+}
+
+// Function to load a replay saved with SaveReplay, replay must not be initialized
+bool LoadReplay(Replay* replay, const char* path) {
+        FILE* file = fopen(path, "rb");
+        if (file == NULL) {
+                return false;
+        }
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        if (size < 13) {
+                fclose(file);
+                return false;
+        }
+        uint8_t* data = new uint8_t[size];
+        bool read = fread(data, 1, size, file) == (size_t)size;
+        fclose(file);
+        if (!read || memcmp(data, "SNRP", 4) != 0 || data[4] != REPLAY_VERSION) {
+                delete[] data;
+                return false;
+        }
+
+        uint64_t seed = 0;
+        for (int i = 0; i < 8; i++) {
+                seed |= (uint64_t)data[5 + i] << (8 * i);
+        }
+        long position = 13;
+        uint64_t width, height, moves, turnCount;
+        // every turn takes at least one byte, a longer count means a broken file
+        if (!ReadVarint(data, size, &position, &width) || !ReadVarint(data, size, &position, &height)
+                || width > MAX_BOARD_CELLS || height > MAX_BOARD_CELLS || !BoardSizeAllowed((int)width, (int)height)
+                || !ReadVarint(data, size, &position, &moves) || !ReadVarint(data, size, &position, &turnCount)
+                || moves > INT32_MAX || turnCount > (uint64_t)(size - position)) {
+                delete[] data;
+                return false;
+        }
+
+        InitReplay(replay, seed, (int)width, (int)height);
+        uint64_t move = 0;
+        for (uint64_t i = 0; i < turnCount; i++) {
+                uint64_t value;
+                if (!ReadVarint(data, size, &position, &value) || (move += value >> 2) > moves) {
+                        FreeReplay(replay);
+                        delete[] data;
+                        return false;
+                }
+                RecordTurn(replay, (int)move, (int)(value & 3));
+        }
+        replay->moves = (int)moves;
+        delete[] data;
+        return true;
+}
+
+// Function to free the memory of a replay
+void FreeReplay(Replay* replay) {
+        delete[] replay->turns;
+        replay->turns = NULL;
+        replay->turnCount = 0;
+        replay->turnCapacity = 0;
+}
+
+// -----------------------
+// REPLAY PLAYER FUNCTIONS
+// -----------------------
+
+// Function to save the current game as the next checkpoint
+static void AddCheckpoint(ReplayPlayer* player) {
+        if (player->checkpointCount == player->checkpointCapacity) {
+                int capacity = player->checkpointCapacity * 2;
+                GameSnapshot* checkpoints = new GameSnapshot[capacity];
+                int* checkpointTurns = new int[capacity];
+                memcpy(checkpoints, player->checkpoints, sizeof(GameSnapshot) * player->checkpointCount);
+                memcpy(checkpointTurns, player->checkpointTurns, sizeof(int) * player->checkpointCount);
+                delete[] player->checkpoints;
+                delete[] player->checkpointTurns;
+                player->checkpoints = checkpoints;
+                player->checkpointTurns = checkpointTurns;
+                player->checkpointCapacity = capacity;
+        }
+        GameSnapshot* checkpoint = &player->checkpoints[player->checkpointCount];
+        InitGameSnapshot(checkpoint);
+        SaveGameSnapshot(checkpoint, &player->game);
+        player->checkpointTurns[player->checkpointCount] = player->nextTurn;
+        player->checkpointCount++;
+}
+
+// Function to start playing a replay, the start of the game is the first checkpoint
+void InitReplayPlayer(ReplayPlayer* player, Replay* replay, int interval) {
+        player->replay = replay;
+        InitGameOfSize(&player->game, replay->seed, replay->width, replay->height);
+        player->nextTurn = 0;
+        player->interval = interval > 0 ? interval : REPLAY_CHECKPOINT_MOVES;
+        player->checkpointCapacity = 16;
+        player->checkpointCount = 0;
+        player->checkpoints = new GameSnapshot[player->checkpointCapacity];
+        player->checkpointTurns = new int[player->checkpointCapacity];
+        AddCheckpoint(player);
+}
+
+// Function to make the next move of the replay with the turns recorded before it
+// Checkpoints are saved the first time the game reaches every interval moves
+int PlayReplayMove(ReplayPlayer* player) {
+        Replay* replay = player->replay;
+        Game* game = &player->game;
+        if (game->gameOver || game->moves >= replay->moves) {
+                return 0;
+        }
+        while (player->nextTurn < replay->turnCount && replay->turns[player->nextTurn].move == game->moves) {
+                TurnSnake(game, replay->turns[player->nextTurn].direction);
+                player->nextTurn++;
+        }
+        int result = StepGame(game, ACTION_NONE);
+        if (game->moves == player->checkpointCount * player->interval) {
+                AddCheckpoint(player);
+        }
+        return result;
+}
+
+// Function to go to the given move, from the nearest checkpoint before it unless the game is already closer
+void SeekReplay(ReplayPlayer* player, int move) {
+        if (move > player->replay->moves) {
+                move = player->replay->moves;
+        }
+        if (move < 0) {
+                move = 0;
+        }
+        int checkpoint = move / player->interval;
+        if (checkpoint >= player->checkpointCount) {
+                checkpoint = player->checkpointCount - 1;
+        }
+        if (move < player->game.moves || checkpoint * player->interval > player->game.moves) {
+                RestoreGameSnapshot(&player->game, &player->checkpoints[checkpoint]);
+                player->nextTurn = player->checkpointTurns[checkpoint];
+        }
+        while (player->game.moves < move && PlayReplayMove(player)) {
+        }
+}
+
+// Function to free the memory of a replay player, the replay itself stays
+void FreeReplayPlayer(ReplayPlayer* player) {
+        for (int i = 0; i < player->checkpointCount; i++) {
+                FreeGameSnapshot(&player->checkpoints[i]);
+        }
+        delete[] player->checkpoints;
+        delete[] player->checkpointTurns;
+        FreeGame(&player->game);
+}
@@ -0,0 +1,86 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// replay: recording the turns of a game and playing them back, without SDL
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include<stdint.h>
+
+#include"game.h"
+
+// ------------------
+// DEFINING CONSTANTS
+// ------------------
+
+#define REPLAY_VERSION 2 // version of the replay file format, 2 added the board size and ranks the free cells in board order
+#define REPLAY_CHECKPOINT_MOVES 1024 // default number of moves between two checkpoints of a ReplayPlayer
+
+// -------------------
+// DEFINING STRUCTURES
+// -------------------
+
+// A turn made by the player, before the move with the given number
+struct ReplayTurn {
+        int move;
+        int direction;
+};
+
+// Everything needed to play a game again: the seed, the size of the board and the turns
+// File format (little endian): "SNRP", version byte, 8 byte seed, then varints: width, height, moves, number of turns
+// and for every turn (moves since the previous turn << 2 | direction)
+struct Replay {
+        uint64_t seed;
+        int width; // the size of the board in cells
+        int height;
+        int moves; // number of moves the recorded game lasted
+        ReplayTurn* turns;
+        int turnCount;
+        int turnCapacity;
+};
+
+// A game of the replay being played back, with a snapshot of the game saved every interval moves
+// so it can jump to any move without playing it from the start. The snapshots keep the snake, not the board,
+// so they take memory of the snake length also on large boards
+struct ReplayPlayer {
+        Replay* replay;
+        Game game;
+        int nextTurn; // index of the next turn of the replay to apply
+        GameSnapshot* checkpoints; // checkpoints[i] is the game after i * interval moves
+        int* checkpointTurns; // nextTurn of every checkpoint
+        int checkpointCount;
+        int checkpointCapacity;
+        int interval;
+};
+
+// ----------------
+// REPLAY FUNCTIONS
+// ----------------
+
+void InitReplay(Replay* replay, uint64_t seed, int width, int height);
+
+// add a turn that was accepted by TurnSnake before the move with the given number (game->moves)
+void RecordTurn(Replay* replay, int move, int direction);
+
+// save and load a replay, both return false when the file cannot be written or read
+bool SaveReplay(Replay* replay, const char* path);
+bool LoadReplay(Replay* replay, const char* path);
+
+void FreeReplay(Replay* replay);
+
+// -----------------------
+// REPLAY PLAYER FUNCTIONS
+// -----------------------
+
+// start playing the replay from the first move, interval is the number of moves between checkpoints
+void InitReplayPlayer(ReplayPlayer* player, Replay* replay, int interval);
+
+// make the next move of the replay, returns the STEP_ flags or 0 when the replay is over
+int PlayReplayMove(ReplayPlayer* player);
+
+// go to the game after the given number of moves (at most the moves of the replay), backwards or forwards
+void SeekReplay(ReplayPlayer* player, int move);
+
+void FreeReplayPlayer(ReplayPlayer* player);
+
+#endif
@@ -0,0 +1,91 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// threadpool: a fixed set of worker threads that split a range of items between them
+
+#include<stddef.h>
+
+#include"threadpool.h"
+
+// Function to run the part of the current job that belongs to the given thread
+static void RunPart(ThreadPool* pool, int thread) {
+        long long count = pool->itemCount;
+        int begin = (int)(count * thread / pool->threadCount);
+        int end = (int)(count * (thread + 1) / pool->threadCount);
+        if (begin < end) {
+                pool->job(pool->context, begin, end);
+        }
+}
+
+// Function run by every worker thread, it sleeps until a new job is posted
+static void WorkerLoop(ThreadPool* pool, int thread) {
+        int seen = 0;
+        while (true) {
+                {
+                        std::unique_lock<std::mutex> lock(pool->mutex);
+                        pool->wake.wait(lock, [&]() { return pool->quit || pool->generation != seen; });
+                        if (pool->quit) {
+                                return;
+                        }
+                        seen = pool->generation;
+                }
+                RunPart(pool, thread);
+                std::lock_guard<std::mutex> lock(pool->mutex);
+                if (--pool->pending == 0) {
+                        pool->finished.notify_one();
+                }
+        }
+}
+
+void InitThreadPool(ThreadPool* pool, int threadCount) {
+        if (threadCount <= 0) {
+                threadCount = (int)std::thread::hardware_concurrency();
+                if (threadCount <= 0) {
+                        threadCount = 1;
+                }
+        }
+        pool->threadCount = threadCount;
+        pool->generation = 0;
+        pool->pending = 0;
+        pool->quit = 0;
+        pool->job = NULL;
+        pool->context = NULL;
+        pool->itemCount = 0;
+        pool->workers = new std::thread[threadCount - 1];
+        for (int i = 1; i < threadCount; i++) {
+                pool->workers[i - 1] = std::thread(WorkerLoop, pool, i);
+        }
+}
+
+void ParallelFor(ThreadPool* pool, int itemCount, ThreadJob job, void* context) {
+        if (pool->threadCount == 1) {
+                if (itemCount > 0) {
+                        job(context, 0, itemCount);
+                }
+                return;
+        }
+        {
+                std::lock_guard<std::mutex> lock(pool->mutex);
+                pool->job = job;
+                pool->context = context;
+                pool->itemCount = itemCount;
+                pool->pending = pool->threadCount - 1;
+                pool->generation++;
+        }
+        pool->wake.notify_all();
+        RunPart(pool, 0);
+        std::unique_lock<std::mutex> lock(pool->mutex);
+        pool->finished.wait(lock, [&]() { return pool->pending == 0; });
+}
+
+void FreeThreadPool(ThreadPool* pool) {
+        {
+                std::lock_guard<std::mutex> lock(pool->mutex);
+                pool->quit = 1;
+        }
+        pool->wake.notify_all();
+        for (int i = 0; i < pool->threadCount - 1; i++) {
+                pool->workers[i].join();
+        }
+        delete[] pool->workers;
+        pool->workers = NULL;
+}
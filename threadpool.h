@@ -0,0 +1,38 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// threadpool: a fixed set of worker threads that split a range of items between them
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+
+// job called by every thread for its own part [begin, end) of the items
+typedef void (*ThreadJob)(void* context, int begin, int end);
+
+struct ThreadPool {
+        std::thread* workers; // threadCount - 1 workers, the calling thread takes the first part itself
+        int threadCount;
+        std::mutex mutex;
+        std::condition_variable wake; // a new job was posted (or the pool quits)
+        std::condition_variable finished; // the last worker finished its part
+        int generation; // number of the current job, workers wait for it to change
+        int pending; // workers that have not finished the current job yet
+        int quit;
+        ThreadJob job;
+        void* context;
+        int itemCount;
+};
+
+// start the pool, threadCount includes the calling thread (0 means one thread per core)
+void InitThreadPool(ThreadPool* pool, int threadCount);
+
+// run job over itemCount items split into equal contiguous parts, returns when all parts are done
+void ParallelFor(ThreadPool* pool, int itemCount, ThreadJob job, void* context);
+
+// stop and join all the workers
+void FreeThreadPool(ThreadPool* pool);
+
+#endif
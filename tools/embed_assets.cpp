@@ -0,0 +1,59 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// embed_assets: turns cs8x8.bmp and blue_dot.bmp into assets_data.h, the pixels compiled into the game
+//
+// build: g++ -O2 tools/embed_assets.cpp -LSDL2-2.0.10/lib -lSDL2 -o embed_assets
+// run it from the main directory after a bitmap changed: ./embed_assets > assets_data.h
+//
+// The pixels are written in ARGB8888, the format of the screen, and the dot is scaled to CELL_SIZE,
+// so the game neither reads the files nor converts or scales anything when it runs
+
+#include<stdio.h>
+
+#include"../draw.h"
+
+// Function to print the pixels of an ARGB8888 surface as a C array, 8 pixels in a line
+void PrintPixels(SDL_Surface* surface, const char* name) {
+        printf("const Uint32 %s[%d * %d] = {\n", name, surface->w, surface->h);
+        int count = surface->w * surface->h;
+        for (int i = 0; i < count; i++) {
+                Uint32* row = (Uint32*)((Uint8*)surface->pixels + (i / surface->w) * surface->pitch);
+                printf("%s0x%08X,%s", i % 8 == 0 ? "        " : "", row[i % surface->w], i % 8 == 7 || i == count - 1 ? "\n" : " ");
+        }
+        printf("};\n");
+}
+
+int main(int, char**) {
+        SDL_Surface* charset = SDL_LoadBMP("./cs8x8.bmp");
+        SDL_Surface* dot = SDL_LoadBMP("./blue_dot.bmp");
+        if (charset == NULL || dot == NULL) {
+                fprintf(stderr, "SDL_LoadBMP error: %s\n", SDL_GetError());
+                return 1;
+        }
+        SDL_Surface* font = SDL_ConvertSurfaceFormat(charset, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_Surface* dotArgb = SDL_ConvertSurfaceFormat(dot, SDL_PIXELFORMAT_ARGB8888, 0);
+        // The dot is scaled the way DrawDot scaled it on every frame before
+        SDL_Surface* scaled = SDL_CreateRGBSurfaceWithFormat(0, CELL_SIZE, CELL_SIZE, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (font == NULL || dotArgb == NULL || scaled == NULL) {
+                fprintf(stderr, "SDL error: %s\n", SDL_GetError());
+                return 1;
+        }
+        SDL_SetSurfaceBlendMode(dotArgb, SDL_BLENDMODE_NONE);
+        SDL_BlitScaled(dotArgb, NULL, scaled, NULL);
+
+        printf("// author: Jan Rudnicki\n");
+        printf("// game: Snake in SDL2\n");
+        printf("// assets_data: generated by tools/embed_assets.cpp from cs8x8.bmp and blue_dot.bmp, do not edit\n\n");
+        printf("#define FONT_SIZE %d // the font is a square bitmap of 16 x 16 glyphs\n", font->w);
+        printf("#define DOT_SIZE %d // the dot was scaled to CELL_SIZE\n\n", CELL_SIZE);
+        PrintPixels(font, "FONT_PIXELS");
+        printf("\n");
+        PrintPixels(scaled, "DOT_PIXELS");
+
+        SDL_FreeSurface(scaled);
+        SDL_FreeSurface(dotArgb);
+        SDL_FreeSurface(font);
+        SDL_FreeSurface(dot);
+        SDL_FreeSurface(charset);
+        return 0;
+}
@@ -0,0 +1,175 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// vecenv: many independent games stepped together, for training and evaluating bots
+
+#include<stddef.h>
+
+#include"vecenv.h"
+
+// Function to get the position of the i-th segment (0 is the head) in the ring buffer of a game
+static int BodySlot(VecEnv* env, int game, int i) {
+        int slot = env->headSlot[game] - i;
+        if (slot < 0) {
+                slot += BOARD_CELLS;
+        }
+        return slot;
+}
+
+// Function to take a free cell of a game for the snake
+static void OccupyCellAt(VecEnv* env, int game, int cell) {
+        env->occupied[(size_t)game * BOARD_WORDS + (cell >> 6)] |= (uint64_t)1 << (cell & 63);
+        env->freeCount[game]--;
+}
+
+// Function to give a cell of the snake of a game back to the free cells
+static void ReleaseCellAt(VecEnv* env, int game, int cell) {
+        env->occupied[(size_t)game * BOARD_WORDS + (cell >> 6)] &= ~((uint64_t)1 << (cell & 63));
+        env->freeCount[game]++;
+}
+
+// Function to put the dot on a random free cell of a game, returns false when the board is full
+// The free cells are ranked in the same order as InitDot ranks them, so the dots follow the same seeds as a Game
+static bool PlaceDotAt(VecEnv* env, int game) {
+        int freeCount = env->freeCount[game];
+        if (freeCount == 0) {
+                return false;
+        }
+        int rank = (int)RandomBelow(&env->rng[game], freeCount);
+        env->dot[game] = SelectFreeCell(env->occupied + (size_t)game * BOARD_WORDS, BOARD_WORDS, rank);
+        return true;
+}
+
+// Function to start a new game in place, only the cells of the old snake are cleared
+static void ResetGameAt(VecEnv* env, int game) {
+        size_t block = (size_t)game * BOARD_CELLS;
+        for (int i = 0; i < env->length[game]; i++) {
+                ReleaseCellAt(env, game, env->body[block + BodySlot(env, game, i)]);
+        }
+        env->length[game] = SNAKE_LENGTH;
+        env->headSlot[game] = env->length[game] - 1;
+        for (int i = 0; i < env->length[game]; i++) {
+                int cell = CellIndex(ROW_CELLS, ROW_CELLS / 2 - i, COL_CELLS / 2);
+                env->body[block + BodySlot(env, game, i)] = cell;
+                OccupyCellAt(env, game, cell);
+        }
+        env->head[game] = env->body[block + env->headSlot[game]];
+        env->grow[game] = 0;
+        env->direction[game] = RIGHT;
+        env->moves[game] = 0;
+        PlaceDotAt(env, game);
+}
+
+// Function to make one move in a single game, with the same rules as StepGame
+static void StepGameAt(VecEnv* env, int game, int action) {
+        size_t block = (size_t)game * BOARD_CELLS;
+        Segment head;
+        head.x = env->head[game] % ROW_CELLS;
+        head.y = env->head[game] / ROW_CELLS;
+        int direction = env->direction[game];
+        // Like TurnSnake, the snake cannot turn before its first move
+        if (action != ACTION_NONE && env->moves[game] > 0 && TurnAllowed(&head, env->length[game] + env->grow[game], direction, action, ROW_CELLS, COL_CELLS)) {
+                direction = action;
+        }
+        // Free the tail first, the head is allowed to move into the cell the tail leaves
+        if (env->grow[game] > 0) {
+                env->grow[game]--;
+        }
+        else {
+                ReleaseCellAt(env, game, env->body[block + BodySlot(env, game, env->length[game] - 1)]);
+                env->length[game]--;
+        }
+        MoveHead(env->occupied + (size_t)game * BOARD_WORDS, ROW_CELLS, COL_CELLS, &head, &direction);
+        env->direction[game] = (int8_t)direction;
+        env->moves[game]++;
+        env->reward[game] = 0;
+        env->done[game] = 0;
+
+        // A head off the board or on the body is not added to the snake, the game is restarted right away
+        int cell = CellIndex(ROW_CELLS, head.x, head.y);
+        if (!InsideBoard(ROW_CELLS, COL_CELLS, head.x, head.y) || CellBit(env->occupied + (size_t)game * BOARD_WORDS, cell)) {
+                env->reward[game] = REWARD_DEATH;
+                env->done[game] = 1;
+        }
+        else {
+                env->headSlot[game] = env->headSlot[game] + 1 == BOARD_CELLS ? 0 : env->headSlot[game] + 1;
+                env->body[block + env->headSlot[game]] = cell;
+                env->length[game]++;
+                env->head[game] = cell;
+                OccupyCellAt(env, game, cell);
+                if (cell == env->dot[game]) {
+                        env->grow[game]++;
+                        env->reward[game] = REWARD_DOT;
+                        if (!PlaceDotAt(env, game)) {
+                                env->reward[game] = REWARD_WIN;
+                                env->done[game] = 1;
+                        }
+                }
+        }
+        if (env->done[game]) {
+                ResetGameAt(env, game);
+        }
+}
+
+// Function run by every thread of the pool for its part of the games
+static void StepRange(void* context, int begin, int end) {
+        VecEnv* env = (VecEnv*)context;
+        for (int game = begin; game < end; game++) {
+                StepGameAt(env, game, env->actions[game]);
+        }
+}
+
+void InitVecEnv(VecEnv* env, int count, int threadCount, uint64_t seed) {
+        size_t cells = (size_t)count * BOARD_CELLS;
+        env->count = count;
+        env->head = new int[count];
+        env->headSlot = new int[count]();
+        env->length = new int[count]();
+        env->grow = new int[count];
+        env->direction = new int8_t[count];
+        env->dot = new int[count];
+        env->freeCount = new int[count];
+        env->rng = new Random[count];
+        env->moves = new int[count];
+        env->reward = new float[count]();
+        env->done = new uint8_t[count]();
+        env->body = new int[cells];
+        env->occupied = new uint64_t[(size_t)count * BOARD_WORDS]();
+        env->actions = NULL;
+        // The seeds of the games are drawn from one generator, the way main() seeds its next games,
+        // so neighbouring games (and the games of neighbouring seeds) do not share the state of their streams
+        Random seeds;
+        SeedRandom(&seeds, seed);
+        for (int game = 0; game < count; game++) {
+                // The bits after the last cell are taken, so they are never drawn as free cells
+                if (BOARD_CELLS % 64 != 0) {
+                        env->occupied[(size_t)game * BOARD_WORDS + BOARD_WORDS - 1] = ~(uint64_t)0 << (BOARD_CELLS % 64);
+                }
+                env->freeCount[game] = BOARD_CELLS;
+                SeedRandom(&env->rng[game], NextRandom(&seeds));
+                ResetGameAt(env, game);
+        }
+        InitThreadPool(&env->pool, threadCount);
+}
+
+void StepVecEnv(VecEnv* env, const int* actions) {
+        env->actions = actions;
+        ParallelFor(&env->pool, env->count, StepRange, env);
+        env->actions = NULL;
+}
+
+void FreeVecEnv(VecEnv* env) {
+        FreeThreadPool(&env->pool);
+        delete[] env->head;
+        delete[] env->headSlot;
+        delete[] env->length;
+        delete[] env->grow;
+        delete[] env->direction;
+        delete[] env->dot;
+        delete[] env->freeCount;
+        delete[] env->rng;
+        delete[] env->moves;
+        delete[] env->reward;
+        delete[] env->done;
+        delete[] env->body;
+        delete[] env->occupied;
+}
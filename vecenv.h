@@ -0,0 +1,58 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// vecenv: many independent games stepped together, for training and evaluating bots
+
+#ifndef VECENV_H
+#define VECENV_H
+
+#include<stdint.h>
+
+#include"game.h"
+#include"threadpool.h"
+
+#define BOARD_CELLS (ROW_CELLS * COL_CELLS) // The number of cells of one board, every game is played on the default board
+#define BOARD_WORDS ((BOARD_CELLS + 63) / 64) // The number of 64 bit words in the occupancy bitset of one board
+
+// Rewards written by StepVecEnv
+#define REWARD_DOT 1.0f // the snake ate the dot
+#define REWARD_DEATH -1.0f // the snake collided with itself or left the board
+#define REWARD_WIN 10.0f // the snake fills the whole board
+
+// N games stored as a struct of arrays, game i owns entry i of every per-game array
+// and the i-th block of BOARD_CELLS (BOARD_WORDS) entries of every per-cell array, so threads never share data
+struct VecEnv {
+        int count; // number of games
+        ThreadPool pool;
+
+        // per-game arrays
+        int* head; // cell of the head
+        int* headSlot; // position of the head in the ring buffer of the game
+        int* length;
+        int* grow; // segments still to be added at the tail
+        int8_t* direction;
+        int* dot; // cell of the dot
+        int* freeCount; // number of cells not taken by the snake
+        Random* rng; // random generator of every game
+        int* moves; // moves made in the current game
+        float* reward; // reward of the last step
+        uint8_t* done; // the last step ended the game, it has already been restarted
+
+        // per-cell arrays, BOARD_CELLS entries per game
+        int* body; // ring buffers with the cells of the snakes, the head is at headSlot
+        uint64_t* occupied; // one bit for every cell taken by the snake, BOARD_WORDS words per game
+
+        const int* actions; // actions of the step in progress
+};
+
+// create count games on threadCount threads (0 means one per core), every game gets its own random stream
+// seeded from a generator seeded with seed
+void InitVecEnv(VecEnv* env, int count, int threadCount, uint64_t seed);
+
+// make one move in every game, actions[i] is a direction or ACTION_NONE
+// finished games are restarted right away and reported through done
+void StepVecEnv(VecEnv* env, const int* actions);
+
+// free all the games and stop the threads
+void FreeVecEnv(VecEnv* env);
+
+#endif
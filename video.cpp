@@ -0,0 +1,165 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// video: writing composed frames to an uncompressed video file on a background thread, without SDL
+
+#include<stddef.h>
+#include<chrono>
+
+#include"video.h"
+
+// ---------------
+// VIDEO FUNCTIONS
+// ---------------
+
+// Function to convert an ARGB8888 frame into packed 24 bit RGB
+static void ConvertToRgb(const uint32_t* pixels, int count, uint8_t* output) {
+        for (int i = 0; i < count; i++) {
+                uint32_t pixel = pixels[i];
+                output[3 * i] = (uint8_t)(pixel >> 16);
+                output[3 * i + 1] = (uint8_t)(pixel >> 8);
+                output[3 * i + 2] = (uint8_t)pixel;
+        }
+}
+
+// Function to convert an ARGB8888 frame into the Y, U and V planes of 4:2:0 video (BT.601, limited range)
+// Every 2 x 2 pixels share one U and one V computed from their average color
+static void ConvertToYuv(const uint32_t* pixels, int width, int height, uint8_t* output) {
+        uint8_t* lumaPlane = output;
+        uint8_t* uPlane = output + width * height;
+        uint8_t* vPlane = uPlane + (width / 2) * (height / 2);
+        for (int y = 0; y < height; y += 2) {
+                const uint32_t* rows[2] = { pixels + y * width, pixels + (y + 1) * width };
+                for (int x = 0; x < width; x += 2) {
+                        int red = 0;
+                        int green = 0;
+                        int blue = 0;
+                        for (int i = 0; i < 4; i++) {
+                                uint32_t pixel = rows[i >> 1][x + (i & 1)];
+                                int r = (pixel >> 16) & 0xFF;
+                                int g = (pixel >> 8) & 0xFF;
+                                int b = pixel & 0xFF;
+                                lumaPlane[(y + (i >> 1)) * width + x + (i & 1)] = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+                                red += r;
+                                green += g;
+                                blue += b;
+                        }
+                        red /= 4;
+                        green /= 4;
+                        blue /= 4;
+                        int chroma = (y / 2) * (width / 2) + x / 2;
+                        uPlane[chroma] = (uint8_t)(((-38 * red - 74 * green + 112 * blue + 128) >> 8) + 128);
+                        vPlane[chroma] = (uint8_t)(((112 * red - 94 * green - 18 * blue + 128) >> 8) + 128);
+                }
+        }
+}
+
+// Function to write one frame to the file, returns false when the write failed
+static bool WriteFrame(VideoWriter* video, const uint32_t* pixels) {
+        if (video->format == VIDEO_Y4M) {
+                ConvertToYuv(pixels, video->width, video->height, video->output);
+                if (fputs("FRAME\n", video->file) < 0) {
+                        return false;
+                }
+        }
+        else {
+                ConvertToRgb(pixels, video->width * video->height, video->output);
+        }
+        return fwrite(video->output, 1, video->frameBytes, video->file) == (size_t)video->frameBytes;
+}
+
+// Function run by the writer thread, it writes the queued slots in order and frees them for the producer
+// The mutex is only held to take a slot and to give it back, the conversion and the write run without it
+static void WriterLoop(VideoWriter* video) {
+        while (true) {
+                int slot;
+                {
+                        std::unique_lock<std::mutex> lock(video->mutex);
+                        video->ready.wait(lock, [&]() { return video->queued > 0 || video->quit; });
+                        if (video->queued == 0) {
+                                return;
+                        }
+                        slot = video->first;
+                }
+                // After a failed write the frames are still taken, so the producer never waits forever
+                bool written = !video->failed && WriteFrame(video, VideoFramePixels(video, slot));
+                std::lock_guard<std::mutex> lock(video->mutex);
+                if (written) {
+                        video->framesWritten++;
+                        video->bytesWritten += video->frameBytes + (video->format == VIDEO_Y4M ? 6 : 0);
+                }
+                else {
+                        video->failed = 1;
+                }
+                video->first = (video->first + 1) % VIDEO_QUEUE_FRAMES;
+                video->queued--;
+                video->done.notify_one();
+        }
+}
+
+bool InitVideoWriter(VideoWriter* video, const char* path, int format, int width, int height, int fps) {
+        video->file = fopen(path, "wb");
+        if (video->file == NULL) {
+                return false;
+        }
+        video->format = format;
+        video->width = width;
+        video->height = height;
+        video->frameBytes = format == VIDEO_Y4M ? width * height + 2 * (width / 2) * (height / 2) : width * height * 3;
+        video->frames = new uint32_t[(size_t)VIDEO_QUEUE_FRAMES * width * height];
+        video->output = new uint8_t[video->frameBytes];
+        video->first = 0;
+        video->queued = 0;
+        video->quit = 0;
+        video->failed = 0;
+        video->framesWritten = 0;
+        video->bytesWritten = 0;
+        video->waits = 0;
+        video->waitSeconds = 0;
+        if (format == VIDEO_Y4M) {
+                int length = fprintf(video->file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps);
+                video->failed = length < 0;
+                video->bytesWritten = length > 0 ? length : 0;
+        }
+        video->writer = std::thread(WriterLoop, video);
+        return true;
+}
+
+// Function to get the free slot for the next frame, the producer waits here only when the writer is a whole queue behind
+int AcquireVideoFrame(VideoWriter* video) {
+        std::unique_lock<std::mutex> lock(video->mutex);
+        if (video->queued == VIDEO_QUEUE_FRAMES) {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                video->done.wait(lock, [&]() { return video->queued < VIDEO_QUEUE_FRAMES; });
+                video->waits++;
+                video->waitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        return (video->first + video->queued) % VIDEO_QUEUE_FRAMES;
+}
+
+// Function to get the pixels of a slot
+uint32_t* VideoFramePixels(VideoWriter* video, int slot) {
+        return video->frames + (size_t)slot * video->width * video->height;
+}
+
+void SubmitVideoFrame(VideoWriter* video) {
+        {
+                std::lock_guard<std::mutex> lock(video->mutex);
+                video->queued++;
+        }
+        video->ready.notify_one();
+}
+
+bool FreeVideoWriter(VideoWriter* video) {
+        {
+                std::lock_guard<std::mutex> lock(video->mutex);
+                video->quit = 1;
+        }
+        video->ready.notify_one();
+        video->writer.join();
+        bool closed = fclose(video->file) == 0;
+        delete[] video->frames;
+        delete[] video->output;
+        video->frames = NULL;
+        video->output = NULL;
+        return closed && !video->failed;
+}
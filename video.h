@@ -0,0 +1,71 @@
+// author: Jan Rudnicki
+// game: Snake in SDL2
+// video: writing composed frames to an uncompressed video file on a background thread, without SDL
+
+#ifndef VIDEO_H
+#define VIDEO_H
+
+#include<stdio.h>
+#include<stdint.h>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+
+// ------------------
+// DEFINING CONSTANTS
+// ------------------
+
+#define VIDEO_QUEUE_FRAMES 8 // Frames waiting for the writer at most, the producer waits only when all of them are taken
+
+// The formats of the video file
+#define VIDEO_Y4M 0 // YUV4MPEG2 with 4:2:0 chroma, plays in mpv and VLC and is read by ffmpeg as it is
+#define VIDEO_RGB 1 // raw 24 bit RGB frames without a header (ffmpeg -f rawvideo -pix_fmt rgb24 -s WxH -r FPS -i FILE)
+
+// -------------------
+// DEFINING STRUCTURES
+// -------------------
+
+// A ring of frame buffers shared by the thread composing the frames and the thread writing them
+// The producer draws straight into a free slot and hands it over, the writer converts and writes the slots in order,
+// so the disk is only waited for when the whole queue is full
+struct VideoWriter {
+        FILE* file;
+        int format;
+        int width; // the size of a frame in pixels, both even for VIDEO_Y4M
+        int height;
+        uint32_t* frames; // VIDEO_QUEUE_FRAMES slots of width * height ARGB8888 pixels
+        uint8_t* output; // one frame in the format of the file, used only by the writer thread
+        int frameBytes; // bytes of a frame in the file, without the Y4M frame header
+        int first; // the oldest slot waiting for the writer
+        int queued; // slots waiting for the writer
+        int quit; // no more frames will come, the writer ends after the queued ones
+        int failed; // a write failed, the next frames are dropped
+        std::thread writer;
+        std::mutex mutex;
+        std::condition_variable ready; // a frame was queued (or the writer has to quit)
+        std::condition_variable done; // a slot was written and is free again
+
+        long long framesWritten; // statistics, updated by the writer thread under the mutex
+        long long bytesWritten;
+        long long waits; // times the producer found the queue full
+        double waitSeconds; // time the producer spent waiting for a free slot
+};
+
+// ---------------
+// VIDEO FUNCTIONS
+// ---------------
+
+// create the file, write its header and start the writer thread, returns false when the file cannot be created
+bool InitVideoWriter(VideoWriter* video, const char* path, int format, int width, int height, int fps);
+
+// the slot to draw the next frame into (width * height ARGB8888 pixels, width pixels in a row), waits while the queue is full
+int AcquireVideoFrame(VideoWriter* video);
+uint32_t* VideoFramePixels(VideoWriter* video, int slot);
+
+// hand the frame drawn into the acquired slot to the writer
+void SubmitVideoFrame(VideoWriter* video);
+
+// write the queued frames, stop the writer and close the file, returns false when any write failed
+bool FreeVideoWriter(VideoWriter* video);
+
+#endif